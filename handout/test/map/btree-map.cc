@@ -0,0 +1,148 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <string>
+#include "btree_map.hpp"
+
+using namespace std;
+
+bool check1() { //insert, find, operator[]
+	sjtu::btree_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 100000; i++) {
+		int a = rand() % 50000, b = rand();
+		if (i & 1) { Q[a] = b; stdQ[a] = b; }
+		else if (Q.insert(sjtu::pair<int, int>(a, b)).second != stdQ.insert(std::pair<int, int>(a, b)).second) return 0;
+	}
+	if (Q.size() != stdQ.size()) return 0;
+	for (int i = 0; i < 50000; i++) {
+		if (Q.count(i) != stdQ.count(i)) return 0;
+		if (stdQ.count(i) && (Q.find(i)->second != stdQ[i] || Q.at(i) != stdQ[i])) return 0;
+	}
+	return 1;
+}
+
+bool check2() { //iterate both ways
+	sjtu::btree_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 30000; i++) {
+		int a = rand(), b = rand();
+		Q[a] = b; stdQ[a] = b;
+	}
+	sjtu::btree_map<int, int>::iterator it = Q.begin();
+	for (std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); ++stdit, ++it)
+		if (it->first != stdit->first || (*it).second != stdit->second) return 0;
+	if (it != Q.end()) return 0;
+	std::map<int, int>::iterator stdit = --stdQ.end();
+	for (it = --Q.end(); it != Q.begin(); --it, --stdit)
+		if (it->first != stdit->first) return 0;
+	return 1;
+}
+
+bool check3() { //erase(it++) keeps the iterator valid
+	sjtu::btree_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 20000; i++) { Q[i] = i; stdQ[i] = i; }
+	sjtu::btree_map<int, int>::iterator it = Q.begin();
+	while (it != Q.end()) {
+		int k = it->first;
+		Q.erase(it++);
+		stdQ.erase(k);
+		if (it != Q.end() && it->first != k + 1) return 0;
+		if (it != Q.end()) ++it;
+	}
+	if (Q.size() != stdQ.size()) return 0;
+	for (int i = 1; i <= 20000; i++)
+		if (Q.count(i) != stdQ.count(i)) return 0;
+	return 1;
+}
+
+bool check4() { //random erase by key and by range
+	sjtu::btree_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 50000; i++) {
+		int a = rand() % 20000;
+		Q[a] = i; stdQ[a] = i;
+		a = rand() % 20000;
+		if (Q.erase(a) != stdQ.erase(a)) return 0;
+	}
+	sjtu::btree_map<int, int>::iterator l = Q.begin(), r;
+	std::map<int, int>::iterator stdl = stdQ.begin(), stdr;
+	for (int i = 0; i < 100; i++) { ++l; ++stdl; }
+	r = l; stdr = stdl;
+	for (int i = 0; i < 1000; i++) { ++r; ++stdr; }
+	Q.erase(l, r);
+	stdQ.erase(stdl, stdr);
+	if (Q.size() != stdQ.size()) return 0;
+	std::map<int, int>::iterator stdit = stdQ.begin();
+	for (sjtu::btree_map<int, int>::const_iterator it = Q.cbegin(); it != Q.cend(); ++it, ++stdit)
+		if (it->first != stdit->first || it->second != stdit->second) return 0;
+	return 1;
+}
+
+bool check5() { //copy, assignment and clear with string keys
+	sjtu::btree_map<string, int> Q;
+	for (int i = 0; i < 10000; i++) Q[to_string(rand())] = i;
+	sjtu::btree_map<string, int> P(Q), O;
+	O = P;
+	Q.clear();
+	if (!Q.empty() || P.size() != O.size()) return 0;
+	sjtu::btree_map<string, int>::const_iterator a = P.cbegin(), b = O.cbegin();
+	for (; a != P.cend(); ++a, ++b)
+		if (a->first != b->first || a->second != b->second) return 0;
+	return b == O.cend();
+}
+
+bool check6() { //exceptions
+	sjtu::btree_map<int, int> Q;
+	int caught = 0;
+	try { Q.at(1); } catch (...) { caught++; }
+	try { Q.erase(Q.begin()); } catch (...) { caught++; }
+	Q[1] = 1;
+	try { --Q.begin(); } catch (...) { caught++; }
+	try { ++Q.end(); } catch (...) { caught++; }
+	try { Q.erase(Q.end()); } catch (...) { caught++; }
+	const sjtu::btree_map<int, int> P(Q);
+	try { P[2]; } catch (...) { caught++; }
+	return caught == 6;
+}
+
+//counts live copies and throws from the copy that brings throwIn to zero
+struct fragile {
+	static int live, throwIn;
+	int v;
+	fragile(int x = 0) :v(x) { live++; }
+	fragile(const fragile &o) :v(o.v) {
+		if (--throwIn == 0) throw 1;
+		live++;
+	}
+	fragile & operator=(const fragile &o) {
+		v = o.v;
+		return *this;
+	}
+	~fragile() { live--; }
+};
+int fragile::live = 0, fragile::throwIn = 0;
+
+bool check7() { //a copy that throws frees what it made and leaves the target alone
+	sjtu::btree_map<int, fragile> Q, P;
+	for (int i = 0; i < 5000; i++) Q[i] = fragile(i);
+	for (int i = 0; i < 10; i++) P[-i] = fragile(i);
+	int before = fragile::live, caught = 0;
+	for (int k = 1; k < 5000; k += 997) {
+		fragile::throwIn = k;
+		try { sjtu::btree_map<int, fragile> R(Q); } catch (...) { caught++; }
+		fragile::throwIn = k;
+		try { P = Q; } catch (...) { caught++; }
+		if (fragile::live != before || P.size() != 10 || P.at(-3).v != 3) return 0;
+	}
+	fragile::throwIn = 0;
+	return caught == 12;
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << " "
+		<< check5() << " " << check6() << " " << check7() << endl;
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <string>
+#include "compact_map.hpp"
+
+using namespace std;
+
+bool check1() { //inserts, erases, nth and rank agree with std::map
+	sjtu::compact_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 60000; i++) {
+		int a = rand() % 10000;
+		if (i % 3 == 0) { if (Q.erase(a) != stdQ.erase(a)) return 0; }
+		else if (i % 3 == 1) { Q[a] = i; stdQ[a] = i; }
+		else if (Q.insert(sjtu::pair<const int, int>(a, i)).second != stdQ.insert(make_pair(a, i)).second) return 0;
+	}
+	if (Q.size() != stdQ.size()) return 0;
+	size_t k = 0;
+	sjtu::compact_map<int, int>::iterator q = Q.begin();
+	for (std::map<int, int>::iterator it = stdQ.begin(); it != stdQ.end(); ++it, ++k, ++q)
+		if (q->first != it->first || q->second != it->second || Q.nth(k)->first != it->first || Q.rank(it->first) != k) return 0;
+	if (q != Q.end()) return 0;
+	for (int i = 0; i < 10000; i += 7) {
+		std::map<int, int>::iterator lb = stdQ.lower_bound(i), ub = stdQ.upper_bound(i);
+		if ((Q.lower_bound(i) == Q.end() ? -1 : Q.lower_bound(i)->first) != (lb == stdQ.end() ? -1 : lb->first)) return 0;
+		if ((Q.upper_bound(i) == Q.end() ? -1 : Q.upper_bound(i)->first) != (ub == stdQ.end() ? -1 : ub->first)) return 0;
+		if (Q.count(i) != stdQ.count(i)) return 0;
+	}
+	return 1;
+}
+
+bool check2() { //iterators survive growth, erase by range and walking backwards
+	sjtu::compact_map<string, int> Q;
+	Q["m"] = 0;
+	sjtu::compact_map<string, int>::iterator m = Q.find("m");
+	for (int i = 0; i < 5000; i++) Q.emplace(to_string(i), i);
+	if (m->first != "m" || Q.size() != 5001) return 0;
+	Q.erase(Q.lower_bound("1"), Q.lower_bound("2"));
+	sjtu::compact_map<string, int>::const_iterator it = Q.cend();
+	string last = "~";
+	int n = 0;
+	while (it != Q.cbegin()) {
+		--it;
+		if (!(it->first < last) || it->first[0] == '1') return 0;
+		last = it->first;
+		n++;
+	}
+	return n == (int)Q.size() && Q.size() == 5001 - 1111 && Q.at("m") == 0;
+}
+
+bool check3() { //copies, reserve, try_emplace, freeze and exceptions
+	sjtu::compact_map<int, string> Q;
+	Q.reserve(1000);
+	for (int i = 0; i < 1000; i++) Q.try_emplace(i, 3, 'a' + i % 26);
+	string &r = Q[500];
+	for (int i = 0; i < 500; i += 2) Q.erase(i);
+	for (int i = 1000; i < 1250; i++) Q[i] = "z";
+	r = "kept";
+	sjtu::compact_map<int, string> P(Q), E;
+	E = P;
+	Q.clear();
+	const sjtu::compact_map<int, string> &C = E;
+	sjtu::frozen_map<int, string> F = C.freeze();
+	if (C.size() != 1000 || C.at(501) != "hhh" || C[500] != "kept" || F.size() != 1000 || F.at(1249) != "z" || !Q.empty()) return 0;
+	int thrown = 0;
+	try { C.at(0); } catch (...) { thrown++; }
+	try { E.erase(E.end()); } catch (...) { thrown++; }
+	try { E.erase(P.begin()); } catch (...) { thrown++; }
+	try { sjtu::compact_map<int, string>::iterator it = E.begin(); --it; } catch (...) { thrown++; }
+	try { *Q.begin(); } catch (...) { thrown++; }
+	return thrown == 5;
+}
+
+int main() {
+	srand(2111);
+	cout << check1() << " " << check2() << " " << check3() << endl;
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "concurrent_map.hpp"
+
+using namespace std;
+
+typedef sjtu::concurrent_map<int, int> C;
+
+bool check1() { //one thread: the same answers as std::map
+	C c;
+	std::map<int, int> stdQ;
+	for (int i = 0; i < 20000; i++) {
+		int a = rand() % 5000, op = rand() % 3;
+		if (op == 0 && c.insert(sjtu::pair<const int, int>(a, i)) != stdQ.insert(std::pair<const int, int>(a, i)).second) return 0;
+		if (op == 1) { c.insert_or_assign(a, i); stdQ[a] = i; }
+		if (op == 2 && c.erase(a) != stdQ.erase(a)) return 0;
+	}
+	if (c.size() != stdQ.size()) return 0;
+	for (int i = 0; i < 5000; i++) {
+		if (c.count(i) != stdQ.count(i)) return 0;
+		if (stdQ.count(i) && c.at(i) != stdQ[i]) return 0;
+		int v = -1;
+		if (c.visit(i, [&](const int &x) { v = x; }) != (stdQ.count(i) == 1)) return 0;
+		if (stdQ.count(i) && v != stdQ[i]) return 0;
+	}
+	C::snapshot_type s = c.snapshot();
+	std::map<int, int>::iterator stdit = stdQ.begin();
+	for (C::snapshot_type::const_iterator it = s.cbegin(); it != s.cend(); ++it, ++stdit)
+		if (it->first != stdit->first || it->second != stdit->second) return 0;
+	return stdit == stdQ.end();
+}
+
+bool check2() { //readers see whole updates while writers run
+	C c;
+	for (int i = 0; i < 1000; i++) c.insert_or_assign(i, 3 * i);
+	std::atomic<bool> done(false), bad(false);
+	vector<thread> readers;
+	for (int t = 0; t < 3; t++) readers.push_back(thread([&, t]() {
+		std::mt19937 gen(t);
+		while (!done) {
+			int k = gen() % 2000;
+			c.visit(k, [&](const int &x) { if (x != 3 * k) bad = true; });
+			if (c.size() < 1000) bad = true;
+		}
+	}));
+	vector<thread> writers;
+	for (int t = 0; t < 2; t++) writers.push_back(thread([&, t]() {
+		for (int i = 1000 + t; i < 2000; i += 2) c.insert(sjtu::pair<const int, int>(i, 3 * i));
+		for (int i = 1000 + t; i < 2000; i += 4) c.erase(i);
+	}));
+	for (size_t i = 0; i < writers.size(); i++) writers[i].join();
+	done = true;
+	for (size_t i = 0; i < readers.size(); i++) readers[i].join();
+	if (bad || c.size() != 1500) return 0;
+	for (int i = 0; i < 2000; i++)
+		if (c.count(i) != (i < 1000 || (i - 1000) % 4 >= 2 ? 1u : 0u)) return 0;
+	return 1;
+}
+
+bool check3() { //copies, clear and exceptions
+	C c;
+	for (int i = 0; i < 100; i++) c.insert_or_assign(i, i);
+	C d(c), e;
+	e = d;
+	c.clear();
+	int caught = 0;
+	try { c.at(1); } catch (...) { caught++; }
+	try { e.at(100); } catch (...) { caught++; }
+	return caught == 2 && c.empty() && d.size() == 100 && e.size() == 100 && e.at(99) == 99;
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << endl;
+	return 0;
+}
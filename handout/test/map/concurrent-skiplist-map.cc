@@ -0,0 +1,110 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "concurrent_skiplist_map.hpp"
+
+using namespace std;
+
+typedef sjtu::concurrent_skiplist_map<int, string> S;
+
+template<class Map>
+bool same(const S &s, const Map &stdQ) {
+	if (s.size() != stdQ.size()) return 0;
+	typename Map::const_iterator stdit = stdQ.begin();
+	for (S::const_iterator it = s.cbegin(); it != s.cend(); ++it, ++stdit)
+		if (stdit == stdQ.end() || it->first != stdit->first || it->second != stdit->second) return 0;
+	return stdit == stdQ.end();
+}
+
+bool check1() { //one thread: the same answers as std::map
+	S s;
+	std::map<int, string> stdQ;
+	for (int i = 0; i < 30000; i++) {
+		int a = rand() % 5000;
+		if (rand() % 3 == 0) {
+			if (s.erase(a) != stdQ.erase(a)) return 0;
+		}
+		else {
+			sjtu::pair<S::iterator, bool> r = s.insert(sjtu::pair<const int, string>(a, to_string(i)));
+			if (r.second != stdQ.insert(std::pair<const int, string>(a, to_string(i))).second || r.first->second != stdQ[a]) return 0;
+		}
+	}
+	for (int i = -10; i < 5010; i++) {
+		if (s.count(i) != stdQ.count(i)) return 0;
+		S::const_iterator it = s.find(i), lb = s.lower_bound(i);
+		std::map<int, string>::iterator stdlb = stdQ.lower_bound(i);
+		if ((it != s.cend()) != (stdQ.count(i) == 1) || (stdQ.count(i) && it->second != stdQ[i])) return 0;
+		if ((lb == s.cend()) != (stdlb == stdQ.end()) || (lb != s.cend() && lb->first != stdlb->first)) return 0;
+	}
+	return same(s, stdQ);
+}
+
+bool check2() { //writers on overlapping keys, readers iterating meanwhile
+	S s;
+	std::atomic<bool> done(false), bad(false);
+	vector<thread> readers;
+	for (int t = 0; t < 2; t++) readers.push_back(thread([&]() {
+		while (!done) {
+			int last = -1;
+			for (S::const_iterator it = s.cbegin(); it != s.cend(); ++it) {
+				if (it->first <= last || it->second != to_string(it->first)) bad = true;
+				last = it->first;
+			}
+		}
+	}));
+	vector<thread> writers;
+	for (int t = 0; t < 4; t++) writers.push_back(thread([&, t]() {
+		std::mt19937 gen(t);
+		for (int i = 0; i < 40000; i++) {
+			int k = gen() % 2000;
+			if (gen() % 2) s.insert(sjtu::pair<const int, string>(k, to_string(k)));
+			else s.erase(k);
+		}
+	}));
+	for (size_t i = 0; i < writers.size(); i++) writers[i].join();
+	done = true;
+	for (size_t i = 0; i < readers.size(); i++) readers[i].join();
+	std::map<int, string> stdQ;
+	for (S::const_iterator it = s.cbegin(); it != s.cend(); ++it) stdQ.insert(std::pair<const int, string>(it->first, it->second));
+	return !bad && same(s, stdQ);
+}
+
+bool check3() { //every thread inserts all keys, then erases the even ones
+	S s;
+	std::atomic<int> inserted(0), erased(0);
+	vector<thread> pool;
+	for (int t = 0; t < 4; t++) pool.push_back(thread([&]() {
+		for (int i = 0; i < 20000; i++)
+			if (s.insert(sjtu::pair<const int, string>(i, "x")).second) inserted++;
+		for (int i = 0; i < 20000; i += 2) erased += (int)s.erase(i);
+	}));
+	for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+	int n = 0;
+	for (S::const_iterator it = s.cbegin(); it != s.cend(); ++it, n++)
+		if (it->first != 2 * n + 1) return 0;
+	return n == 10000 && s.size() == 10000 && inserted - erased == 10000;
+}
+
+bool check4() { //copies, clear and exceptions
+	S s;
+	for (int i = 0; i < 100; i++) s.insert(sjtu::pair<const int, string>(i, "a"));
+	S t(s), u;
+	u = t;
+	s.clear();
+	int caught = 0;
+	try { *s.cend(); } catch (...) { caught++; }
+	S::const_iterator it = u.find(99);
+	try { ++it; ++it; } catch (...) { caught++; }
+	return caught == 2 && s.empty() && s.cbegin() == s.cend() && t.size() == 100 && u.size() == 100;
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << endl;
+	return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <string>
+#include "flat_map.hpp"
+
+using namespace std;
+
+bool check1() { //random inserts, erases and lookups agree with std::map
+	sjtu::flat_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 0; i < 20000; i++) {
+		int op = rand() % 6, a = rand() % 3000;
+		if (op == 0) { Q[a] = i; stdQ[a] = i; }
+		else if (op == 1) {
+			if (Q.insert(sjtu::pair<const int, int>(a, i)).second != stdQ.insert(make_pair(a, i)).second) return 0;
+		}
+		else if (op == 2) { if (Q.erase(a) != stdQ.erase(a)) return 0; }
+		else if (op == 3) {
+			sjtu::flat_map<int, int>::iterator it = Q.find(a);
+			if ((it == Q.end()) != (stdQ.count(a) == 0)) return 0;
+			if (it != Q.end()) { it->second++; stdQ[a]++; Q.erase(++it == Q.end() ? Q.begin() : it); }
+			if (it != Q.end()) stdQ.erase(stdQ.upper_bound(a) == stdQ.end() ? stdQ.begin() : stdQ.upper_bound(a));
+		}
+		else if (op == 4) {
+			sjtu::flat_map<int, int>::iterator l = Q.lower_bound(a), u = Q.upper_bound(a + 5);
+			Q.erase(l, u);
+			stdQ.erase(stdQ.lower_bound(a), stdQ.upper_bound(a + 5));
+		}
+		else if (Q.count(a) != stdQ.count(a) || (stdQ.count(a) && Q.at(a) != stdQ[a])) return 0;
+		if (Q.size() != stdQ.size()) return 0;
+	}
+	std::map<int, int>::iterator s = stdQ.begin();
+	for (sjtu::flat_map<int, int>::const_iterator it = Q.cbegin(); it != Q.cend(); ++it, ++s)
+		if (it->first != s->first || (*it).second != s->second) return 0;
+	return 1;
+}
+
+bool check2() { //bulk insertion: sorted appends, unsorted batches and duplicates
+	sjtu::flat_map<string, int> Q;
+	std::map<string, int> stdQ;
+	vector<sjtu::pair<string, int>> batch;
+	for (int round = 0; round < 50; round++) {
+		batch.clear();
+		int n = rand() % 200;
+		bool ascending = (round % 3 == 0);
+		for (int i = 0; i < n; i++) {
+			int k = ascending ? round * 1000 + i : rand() % 2000;
+			batch.push_back(sjtu::pair<string, int>(to_string(100000 + k), round * 1000 + i));
+			stdQ.insert(make_pair(to_string(100000 + k), round * 1000 + i));
+		}
+		Q.insert(batch.begin(), batch.end());
+		if (Q.size() != stdQ.size()) return 0;
+	}
+	std::map<string, int>::iterator s = stdQ.begin();
+	for (sjtu::flat_map<string, int>::iterator it = Q.begin(); it != Q.end(); ++it, ++s)
+		if (it->first != s->first || it->second != s->second) return 0;
+	sjtu::flat_map<string, int> P(stdQ.begin(), stdQ.end());
+	return P.size() == Q.size() && P.at("100003") == Q.at("100003");
+}
+
+bool check3() { //reserve, copies, emplace and exceptions
+	sjtu::flat_map<int, string> Q;
+	Q.reserve(100);
+	if (Q.capacity() < 100 || !Q.empty()) return 0;
+	for (int i = 99; i >= 0; i--) Q.emplace(i, to_string(i));
+	if (Q.capacity() != 100 || Q.try_emplace(5, "x").second || Q[5] != "5") return 0;
+	sjtu::flat_map<int, string> P(Q), R;
+	R = P;
+	Q.clear();
+	const sjtu::flat_map<int, string> &C = R;
+	if (C.size() != 100 || C.at(42) != "42" || C[99] != "99" || C.find(100) != C.cend() || !Q.empty()) return 0;
+	int thrown = 0;
+	try { C.at(100); } catch (...) { thrown++; }
+	try { R.erase(R.end()); } catch (...) { thrown++; }
+	try { R.erase(P.begin()); } catch (...) { thrown++; }
+	try { sjtu::flat_map<int, string>::iterator it = R.begin(); --it; } catch (...) { thrown++; }
+	try { *R.end(); } catch (...) { thrown++; }
+	return thrown == 5;
+}
+
+int main() {
+	srand(2003);
+	cout << check1() << " " << check2() << " " << check3() << endl;
+	return 0;
+}
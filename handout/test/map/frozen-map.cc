@@ -0,0 +1,71 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <string>
+#include "map.hpp"
+
+using namespace std;
+
+bool check1() { //find, count, at, lower_bound and upper_bound agree with std::map
+	for (int n = 0; n < 200; n++) {
+		sjtu::map<int, int> Q;
+		std::map<int, int> stdQ;
+		for (int i = 0; i < n; i++) {
+			int a = rand() % (3 * n + 1);
+			Q[a] = i; stdQ[a] = i;
+		}
+		sjtu::frozen_map<int, int> F = Q.freeze();
+		if (F.size() != stdQ.size() || F.empty() != stdQ.empty()) return 0;
+		for (int k = -2; k < 3 * n + 3; k++) {
+			if (F.count(k) != stdQ.count(k)) return 0;
+			sjtu::frozen_map<int, int>::const_iterator it = F.find(k);
+			if (stdQ.count(k) && (it == F.cend() || it->first != k || it->second != stdQ[k] || F.at(k) != stdQ[k])) return 0;
+			if (!stdQ.count(k) && it != F.cend()) return 0;
+			std::map<int, int>::iterator lb = stdQ.lower_bound(k), ub = stdQ.upper_bound(k);
+			it = F.lower_bound(k);
+			if ((lb == stdQ.end()) != (it == F.cend()) || (lb != stdQ.end() && (*it).first != lb->first)) return 0;
+			it = F.upper_bound(k);
+			if ((ub == stdQ.end()) != (it == F.cend()) || (ub != stdQ.end() && (*it).first != ub->first)) return 0;
+		}
+	}
+	return 1;
+}
+
+bool check2() { //ordered iteration both ways
+	sjtu::map<string, int> Q;
+	for (int i = 0; i < 1000; i++) Q[to_string(rand() % 5000)] = i;
+	sjtu::frozen_map<string, int> F = Q.freeze();
+	sjtu::map<string, int>::const_iterator q = Q.cbegin();
+	for (sjtu::frozen_map<string, int>::const_iterator it = F.cbegin(); it != F.cend(); ++it, ++q)
+		if (q == Q.cend() || it->first != q->first || it->second != q->second) return 0;
+	if (q != Q.cend()) return 0;
+	sjtu::frozen_map<string, int>::const_iterator it = F.cend();
+	do {
+		--it; --q;
+		if (it->first != q->first) return 0;
+	} while (it != F.cbegin());
+	return 1;
+}
+
+bool check3() { //copies, empty maps and exceptions
+	sjtu::map<int, string> Q;
+	for (int i = 0; i < 100; i++) Q[i * 2] = to_string(i);
+	sjtu::frozen_map<int, string> F = Q.freeze(), G, E = sjtu::map<int, string>().freeze();
+	Q.clear();
+	G = F;
+	sjtu::frozen_map<int, string> H(G);
+	if (H.size() != 100 || H.at(42) != "21" || G[198] != "99" || F.count(3) != 0) return 0;
+	if (!E.empty() || E.cbegin() != E.cend()) return 0;
+	int thrown = 0;
+	try { F.at(3); } catch (...) { thrown++; }
+	try { sjtu::frozen_map<int, string>::const_iterator it = F.cend(); ++it; } catch (...) { thrown++; }
+	try { sjtu::frozen_map<int, string>::const_iterator it = F.cbegin(); --it; } catch (...) { thrown++; }
+	try { *E.cbegin(); } catch (...) { thrown++; }
+	return thrown == 4;
+}
+
+int main() {
+	srand(1901);
+	cout << check1() << " " << check2() << " " << check3() << endl;
+	return 0;
+}
@@ -0,0 +1,172 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <string>
+#include <atomic>
+#include "map_algebra.hpp"
+
+using namespace std;
+
+template<class Map>
+bool same(sjtu::map<int, string> &Q, const Map &stdQ) {
+	if (Q.size() != stdQ.size()) return 0;
+	typename Map::const_iterator stdit = stdQ.begin();
+	for (sjtu::map<int, string>::iterator it = Q.begin(); it != Q.end(); ++it, ++stdit)
+		if (it->first != stdit->first || it->second != stdit->second) return 0;
+	if (stdit != stdQ.end()) return 0;
+	stdit = stdQ.end();
+	for (sjtu::map<int, string>::iterator it = Q.end(); it != Q.begin();)
+		if ((--it)->first != (--stdit)->first) return 0;
+	return Q.size() == 0 || (Q.begin() + (Q.size() - 1))->first == (--stdQ.end())->first;
+}
+
+void fill(sjtu::map<int, string> &Q, std::map<int, string> &stdQ, int n, int range, const string &tag) {
+	for (int i = 0; i < n; i++) {
+		int a = rand() % range;
+		Q[a] = tag + to_string(i); stdQ[a] = tag + to_string(i);
+	}
+}
+
+struct concat {
+	void operator()(string &kept, string &other) const { kept += other; }
+};
+
+bool check1() { //union with each policy and thread count
+	for (unsigned threads = 1; threads <= 8; threads *= 2) {
+		sjtu::map<int, string> P, Q, R, S;
+		std::map<int, string> stdP, stdQ, stdR, stdS;
+		fill(P, stdP, 20000, 50000, "p"); fill(Q, stdQ, 3000, 50000, "q");
+		fill(R, stdR, 100, 50000, "r"); fill(S, stdS, 30000, 50000, "s");
+		sjtu::map<int, string> U = sjtu::map_union(P, Q, sjtu::keep_first(), threads);
+		for (std::map<int, string>::iterator it = stdQ.begin(); it != stdQ.end(); ++it) stdP.insert(*it);
+		if (!same(U, stdP) || !P.empty() || !Q.empty()) return 0;
+		sjtu::map<int, string> V = sjtu::map_union(R, U, sjtu::keep_second(), threads);
+		for (std::map<int, string>::iterator it = stdR.begin(); it != stdR.end(); ++it) stdP.insert(*it);
+		if (!same(V, stdP)) return 0;
+		sjtu::map<int, string> W = sjtu::map_union(V, S, concat(), threads);
+		for (std::map<int, string>::iterator it = stdS.begin(); it != stdS.end(); ++it) stdP[it->first] += it->second;
+		if (!same(W, stdP)) return 0;
+	}
+	return 1;
+}
+
+bool check2() { //intersection and difference
+	for (unsigned threads = 1; threads <= 8; threads *= 2) {
+		sjtu::map<int, string> P, Q, R, S;
+		std::map<int, string> stdP, stdQ, stdR, stdS, stdI, stdD;
+		fill(P, stdP, 20000, 40000, "p"); fill(Q, stdQ, 20000, 40000, "q");
+		fill(R, stdR, 20000, 40000, "r"); fill(S, stdS, 500, 40000, "s");
+		sjtu::map<int, string> I = sjtu::map_intersection(P, Q, concat(), threads);
+		for (std::map<int, string>::iterator it = stdP.begin(); it != stdP.end(); ++it)
+			if (stdQ.count(it->first)) stdI[it->first] = it->second + stdQ[it->first];
+		if (!same(I, stdI) || !P.empty() || !Q.empty()) return 0;
+		sjtu::map<int, string> D = sjtu::map_difference(R, S, threads);
+		for (std::map<int, string>::iterator it = stdR.begin(); it != stdR.end(); ++it)
+			if (!stdS.count(it->first)) stdD.insert(*it);
+		if (!same(D, stdD) || !R.empty() || !S.empty()) return 0;
+		sjtu::map<int, string> E = sjtu::map_difference(I, D, threads);
+		for (std::map<int, string>::iterator it = stdD.begin(); it != stdD.end(); ++it) stdI.erase(it->first);
+		if (!same(E, stdI)) return 0;
+	}
+	return 1;
+}
+
+bool check3() { //results and drained inputs stay usable
+	sjtu::map<int, string> P, Q;
+	std::map<int, string> stdP;
+	for (int i = 0; i < 10000; i++) { P[2 * i] = "even"; Q[3 * i] = "three"; }
+	sjtu::map<int, string> I = sjtu::map_intersection(P, Q);
+	for (int i = 0; i < 10000; i++) { P[i] = "p"; Q[i] = "q"; I[6 * i + 1] = "i"; }
+	for (int i = 0; i < 20000; i += 6) stdP[i] = "even";
+	for (int i = 0; i < 10000; i++) stdP[6 * i + 1] = "i";
+	sjtu::map<int, string> C(I);
+	I.clear();
+	return same(C, stdP) && P.size() == 10000 && Q.size() == 10000 && Q.at(9999) == "q";
+}
+
+bool check4() { //empty maps, one map on both sides and copy-on-write inputs
+	sjtu::map<int, string> P, Q, E, F;
+	for (int i = 0; i < 1000; i++) P[i] = "p";
+	sjtu::map<int, string> A = sjtu::map_union(E, F), B = sjtu::map_intersection(P, E);
+	sjtu::map<int, string> C = sjtu::map_union(Q, Q);
+	for (int i = 0; i < 1000; i++) P[i] = "p";
+	sjtu::map<int, string> D = sjtu::map_intersection(P, P);
+	if (D.size() != 1000 || !P.empty()) return 0;
+	for (int i = 0; i < 1000; i++) Q[i] = "q";
+	Q.set_copy_on_write(true);
+	sjtu::map<int, string> Q2(Q);
+	sjtu::map<int, string> G = sjtu::map_difference(Q, D);
+	return A.empty() && B.empty() && C.empty() && G.empty() && Q.empty() && D.empty()
+		&& Q2.size() == 1000 && Q2.at(999) == "q";
+}
+
+struct throwAt {
+	int bad;
+	void operator()(int &kept, int &) const { if (kept == bad) throw sjtu::runtime_error(); }
+};
+
+bool check5() { //resolve throwing on any thread reaches the caller after the workers stop
+	int caught = 0;
+	for (int bad = 0; bad < 200000; bad += 24999) {
+		sjtu::map<int, int> P, Q;
+		for (int i = 0; i < 200000; i++) P[i] = i;
+		for (int i = 0; i < 200000; i += 3) Q[i] = i;
+		try { sjtu::map<int, int> U = sjtu::map_union(P, Q, throwAt{ bad - bad % 3 }, 4); }
+		catch (sjtu::runtime_error &) { caught++; }
+		if (!P.empty() || !Q.empty()) return 0;
+		P[1] = 1;
+		if (P.size() != 1) return 0;
+	}
+	return caught == 9;
+}
+
+//counts the values alive, to see every element is destroyed once
+struct tracked {
+	static std::atomic<int> live;
+	int v;
+	tracked(int v = 0) :v(v) { live++; }
+	tracked(const tracked &other) :v(other.v) { live++; }
+	tracked & operator=(const tracked &other) { v = other.v; return *this; }
+	~tracked() { live--; }
+};
+std::atomic<int> tracked::live(0);
+//throws once the budget of comparisons runs out
+std::atomic<long> budget(-1);
+struct fragileLess {
+	bool operator()(int a, int b) const {
+		if (budget.load() >= 0 && budget-- == 0) throw sjtu::runtime_error();
+		return a < b;
+	}
+};
+
+bool check6() { //a throwing comparison destroys every element in flight, on any thread
+	typedef sjtu::map<int, tracked, fragileLess> tmap;
+	int caught = 0;
+	for (int o = 0; o < 3; o++)
+		for (unsigned threads = 1; threads <= 4; threads += 3)
+			for (long at = 0; at < 400000; at = at * 3 + 7) {
+				{
+					tmap P, Q;
+					for (int i = 0; i < 60000; i++) P[i] = tracked(i);
+					for (int i = 0; i < 60000; i += 5) Q[i * 2] = tracked(i);
+					budget = at;
+					try {
+						tmap U = o == 0 ? sjtu::map_union(P, Q, sjtu::keep_first(), threads)
+							: o == 1 ? sjtu::map_intersection(P, Q, sjtu::keep_first(), threads) : sjtu::map_difference(P, Q, threads);
+					}
+					catch (sjtu::runtime_error &) { caught++; }
+					budget = -1;
+					if (!P.empty() || !Q.empty() || tracked::live != 0) return 0;
+					P[1] = tracked(1);
+					if (P.size() != 1) return 0;
+				}
+				if (tracked::live != 0) return 0;
+			}
+	return caught > 0;
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << " " << check5() << " " << check6() << endl;
+	return 0;
+}
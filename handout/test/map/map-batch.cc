@@ -0,0 +1,70 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <string>
+#include "map.hpp"
+
+using namespace std;
+
+bool check1() { //find_batch and count_batch agree with find and count
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 0; i < 50000; i++) {
+		int a = rand() % 100000;
+		Q[a] = i; stdQ[a] = i;
+	}
+	for (int n = 0; n < 300; n += 7) {
+		vector<int> keys(n + 1);
+		for (int i = 0; i < n; i++) keys[i] = rand() % 100010 - 5;
+		vector<sjtu::map<int, int>::iterator> out(n + 1);
+		vector<size_t> counts(n + 1);
+		Q.find_batch(&keys[0], n, &out[0]);
+		size_t hits = Q.count_batch(&keys[0], n, &counts[0]), stdHits = 0;
+		for (int i = 0; i < n; i++) {
+			stdHits += stdQ.count(keys[i]);
+			if (counts[i] != stdQ.count(keys[i])) return 0;
+			if (!stdQ.count(keys[i]) && out[i] != Q.end()) return 0;
+			if (stdQ.count(keys[i]) && (out[i] == Q.end() || out[i]->first != keys[i] || out[i]->second != stdQ[keys[i]])) return 0;
+		}
+		if (hits != stdHits || Q.count_batch(&keys[0], n) != stdHits) return 0;
+	}
+	return 1;
+}
+
+bool check2() { //string keys, const maps, iterators that write
+	sjtu::map<string, int> Q;
+	for (int i = 0; i < 1000; i++) Q[to_string(i * 3)] = i;
+	vector<string> keys;
+	for (int i = 0; i < 100; i++) keys.push_back(to_string(i));
+	const sjtu::map<string, int> &P = Q;
+	vector<sjtu::map<string, int>::const_iterator> out(100);
+	P.find_batch(&keys[0], 100, &out[0]);
+	for (int i = 0; i < 100; i++)
+		if ((out[i] != P.cend()) != (i % 3 == 0) || (i % 3 == 0 && out[i]->second != i / 3)) return 0;
+	vector<sjtu::map<string, int>::iterator> wout(100);
+	Q.find_batch(&keys[0], 100, &wout[0]);
+	for (int i = 0; i < 100; i += 3) wout[i]->second = -1;
+	return Q.count_batch(&keys[0], 100) == 34 && Q["99"] == -1 && Q["3"] == -1 && Q["300"] == 100;
+}
+
+bool check3() { //empty and copy-on-write maps
+	sjtu::map<int, int> E, Q;
+	int keys[3] = { 1, 2, 3 };
+	size_t counts[3];
+	sjtu::map<int, int>::iterator out[3];
+	E.find_batch(keys, 3, out);
+	if (E.count_batch(keys, 3, counts) != 0 || counts[0] != 0 || out[2] != E.end()) return 0;
+	for (int i = 0; i < 10; i++) Q[i] = i;
+	Q.set_copy_on_write(true);
+	sjtu::map<int, int> P(Q);
+	Q.find_batch(keys, 3, out);
+	out[0]->second = 100;
+	return P.at(1) == 1 && Q.at(1) == 100 && P.count_batch(keys, 3) == 3;
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << endl;
+	return 0;
+}
@@ -0,0 +1,57 @@
+// Union, intersection and difference of two large sjtu::maps with 1, 2, 4, ...
+// threads, against an insert (or find and erase) loop on one thread.
+// usage: map-bench-algebra [number of keys] [max threads]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include "map_algebra.hpp"
+
+typedef sjtu::map<unsigned, int> Map;
+
+//wall clock, the work is spread over threads
+double since(std::chrono::steady_clock::time_point st) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - st).count();
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 1000000);
+	unsigned maxThreads = (argc > 2 ? atoi(argv[2]) : std::thread::hardware_concurrency());
+	if (maxThreads == 0) maxThreads = 1;
+	std::mt19937 gen(2017);
+	Map a, b;
+	//about half of b's keys are in a too
+	for (int i = 0; i < n; i++) {
+		unsigned k = gen() % (2u * n);
+		a[k] = i;
+		b[gen() % (2u * n)] = i;
+	}
+	printf("%d and %d keys\n", (int)a.size(), (int)b.size());
+
+	Map x(a), y(b);
+	std::chrono::steady_clock::time_point st = std::chrono::steady_clock::now();
+	for (Map::const_iterator it = y.cbegin(); it != y.cend(); ++it) x.insert(*it);
+	printf("insert loop   union %.3fs", since(st));
+	st = std::chrono::steady_clock::now();
+	x = a;
+	for (Map::const_iterator it = y.cbegin(); it != y.cend(); ++it) x.erase(it->first);
+	printf("   difference %.3fs  [%d]\n", since(st), (int)x.size());
+
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+		double t[3];
+		size_t sizes[3];
+		for (int op = 0; op < 3; op++) {
+			Map p(a), q(b);
+			st = std::chrono::steady_clock::now();
+			Map r = (op == 0 ? sjtu::map_union(p, q, sjtu::keep_first(), threads)
+				: op == 1 ? sjtu::map_intersection(p, q, sjtu::keep_first(), threads) : sjtu::map_difference(p, q, threads));
+			t[op] = since(st);
+			sizes[op] = r.size();
+		}
+		printf("%2u threads    union %.3fs   intersection %.3fs   difference %.3fs  [%d %d %d]\n", threads,
+			t[0], t[1], t[2], (int)sizes[0], (int)sizes[1], (int)sizes[2]);
+	}
+	return 0;
+}
@@ -0,0 +1,50 @@
+// Counts heap allocations made by sjtu::map::insert / erase.
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ctime>
+#include "map.hpp"
+
+static long long allocCount = 0;
+
+void *operator new(size_t n) {
+	allocCount++;
+	void *p = malloc(n);
+	if (p == NULL) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+const int N = 1000000;
+
+int main() {
+	sjtu::map<int, int> Q;
+	int *keys = (int *)malloc(sizeof(int) * N);
+	srand(20171);
+	for (int i = 0; i < N; i++) keys[i] = rand();
+
+	long long before = allocCount;
+	clock_t st = clock();
+	int inserted = 0;
+	for (int i = 0; i < N; i++)
+		if (Q.insert(sjtu::pair<int, int>(keys[i], i)).second) inserted++;
+	double insertTime = double(clock() - st) / CLOCKS_PER_SEC;
+	long long insertAllocs = allocCount - before;
+
+	before = allocCount;
+	st = clock();
+	for (int i = 0; i < N; i++) {
+		sjtu::map<int, int>::iterator it = Q.find(keys[i]);
+		if (it != Q.end()) Q.erase(it);
+	}
+	double eraseTime = double(clock() - st) / CLOCKS_PER_SEC;
+	long long eraseAllocs = allocCount - before;
+
+	printf("insert: %d elements, %lld allocations, %.4f allocations/insert, %.3fs\n",
+		inserted, insertAllocs, double(insertAllocs) / inserted, insertTime);
+	printf("erase:  %d elements, %lld allocations, %.3fs\n", inserted, eraseAllocs, eraseTime);
+	free(keys);
+	return (insertAllocs <= inserted && eraseAllocs == 0) ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// Random lookups in an sjtu::map much larger than the last-level cache, one key at
+// a time against find_batch and count_batch on batches of keys.
+// usage: map-bench-batch [number of keys] [number of lookups] [batch size]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "map.hpp"
+
+typedef sjtu::map<unsigned, unsigned> Map;
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 8000000);
+	int q = (argc > 2 ? atoi(argv[2]) : 2000000);
+	int batch = (argc > 3 ? atoi(argv[3]) : 128);
+	std::mt19937 gen(2017);
+	//nodes are allocated in random key order, so neighbours in the tree are far apart in memory
+	std::vector<sjtu::pair<unsigned, unsigned>> elements;
+	elements.reserve(n);
+	for (int i = 0; i < n; i++) elements.push_back(sjtu::pair<unsigned, unsigned>(gen() % (2u * n), i));
+	Map m(elements.begin(), elements.end());
+	std::vector<unsigned> keys(q);
+	for (int i = 0; i < q; i++) keys[i] = gen() % (2u * n);
+	printf("%d keys, %d lookups in batches of %d\n", (int)m.size(), q, batch);
+
+	clock_t st = clock();
+	unsigned long long sum = 0;
+	for (int i = 0; i < q; i++) {
+		Map::const_iterator it = m.find(keys[i]);
+		if (it != m.cend()) sum += it->second;
+	}
+	double one = since(st);
+
+	st = clock();
+	unsigned long long sumBatch = 0;
+	std::vector<Map::const_iterator> out(batch);
+	const Map &cm = m;
+	for (int i = 0; i < q; i += batch) {
+		int b = (q - i < batch ? q - i : batch);
+		cm.find_batch(&keys[i], b, &out[0]);
+		for (int j = 0; j < b; j++)
+			if (out[j] != cm.cend()) sumBatch += out[j]->second;
+	}
+	double batched = since(st);
+
+	st = clock();
+	size_t hits = 0;
+	for (int i = 0; i < q; i++) hits += m.count(keys[i]);
+	double countOne = since(st);
+
+	st = clock();
+	size_t hitsBatch = 0;
+	for (int i = 0; i < q; i += batch) hitsBatch += m.count_batch(&keys[i], (q - i < batch ? q - i : batch));
+	double countBatched = since(st);
+
+	printf("find   %.3fs   find_batch  %.3fs   %.2fx  [%llu %llu]\n", one, batched, one / batched, sum, sumBatch);
+	printf("count  %.3fs   count_batch %.3fs   %.2fx  [%d %d]\n", countOne, countBatched, countOne / countBatched, (int)hits, (int)hitsBatch);
+	return 0;
+}
@@ -0,0 +1,51 @@
+// Compares sjtu::map and sjtu::btree_map on insert, lookup and iteration.
+// usage: map-bench-btree [number of keys]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include "map.hpp"
+#include "btree_map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+template<class Map>
+void bench(const char *name, const unsigned *keys, int n) {
+	Map m;
+	clock_t st = clock();
+	for (int i = 0; i < n; i++) m[keys[i]] = i;
+	double insertTime = since(st);
+
+	std::mt19937 gen(1);
+	st = clock();
+	long long sum = 0;
+	for (int i = 0; i < n; i++) {
+		typename Map::const_iterator it = static_cast<const Map &>(m).find(keys[gen() % n]);
+		sum += it->second;
+	}
+	double findTime = since(st);
+
+	st = clock();
+	for (int i = 0; i < n; i++) sum += m.count(gen());
+	double missTime = since(st);
+
+	st = clock();
+	for (typename Map::const_iterator it = m.cbegin(); it != m.cend(); ++it) sum += it->second;
+	double scanTime = since(st);
+
+	printf("%-10s insert %.3fs  find %.3fs (%.1f Mops/s)  miss %.3fs  scan %.3fs  [%lld]\n", name,
+		insertTime, findTime, n / findTime / 1e6, missTime, scanTime, sum);
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 2000000);
+	unsigned *keys = new unsigned[n];
+	std::mt19937 gen(2017);
+	for (int i = 0; i < n; i++) keys[i] = gen();
+	printf("%d keys\n", n);
+	bench<sjtu::map<unsigned, int>>("map", keys, n);
+	bench<sjtu::btree_map<unsigned, int>>("btree_map", keys, n);
+	delete[] keys;
+	return 0;
+}
@@ -0,0 +1,47 @@
+// Compares n inserts with the range constructor on sorted and shuffled input.
+// usage: map-bench-build [number of keys]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <algorithm>
+#include "map.hpp"
+
+typedef sjtu::map<int, int> Map;
+typedef sjtu::pair<int, int> Pair;
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+void bench(const char *name, const Pair *a, int n) {
+	clock_t st = clock();
+	Map m1;
+	for (int i = 0; i < n; i++) m1.insert(a[i]);
+	double insertTime = since(st);
+
+	st = clock();
+	Map m2(a, a + n);
+	double buildTime = since(st);
+
+	bool same = (m1.size() == m2.size());
+	Map::const_iterator p = m1.cbegin(), q = m2.cbegin();
+	for (; same && p != m1.cend(); ++p, ++q) same = (p->first == q->first && p->second == q->second);
+	printf("%-9s insert loop %.3fs  range constructor %.3fs  %s\n", name, insertTime, buildTime, same ? "same" : "DIFFERENT");
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 1000000);
+	int *key = new int[n];
+	for (int i = 0; i < n; i++) key[i] = 2 * i;
+	Pair *a = static_cast<Pair *>(::operator new(sizeof(Pair) * n));
+	for (int i = 0; i < n; i++) new (a + i) Pair(key[i], i);
+	bench("sorted", a, n);
+
+	std::shuffle(key, key + n, std::mt19937(2017));
+	for (int i = 0; i < n; i++) new (a + i) Pair(key[i], i);
+	bench("shuffled", a, n);
+
+	::operator delete(a);
+	delete[] key;
+	return 0;
+}
@@ -0,0 +1,75 @@
+// Heap bytes per entry of sjtu::map against sjtu::compact_map, and the time to
+// build each from random keys and to look keys up in it.
+// usage: map-bench-compact [number of keys]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <malloc.h>
+#include <new>
+#include <random>
+#include <vector>
+#include "map.hpp"
+#include "compact_map.hpp"
+
+//live heap bytes, as malloc rounds the blocks up. glibc only; the operators stay out of line
+//so gcc does not take new's malloc and delete's free for a mismatched pair
+static long long liveBytes = 0;
+
+__attribute__((noinline)) void *operator new(size_t n) {
+	void *p = malloc(n);
+	if (p == NULL) throw std::bad_alloc();
+	liveBytes += malloc_usable_size(p);
+	return p;
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+	liveBytes -= malloc_usable_size(p);
+	free(p);
+}
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept {
+	liveBytes -= malloc_usable_size(p);
+	free(p);
+}
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+typedef sjtu::map<unsigned, unsigned> Map;
+typedef sjtu::compact_map<unsigned, unsigned> Compact;
+
+void reserve(Map &, size_t) {}
+void reserve(Compact &m, size_t n) { m.reserve(n); }
+
+template<class Map>
+void bench(const char *name, const std::vector<unsigned> &keys, bool reserved) {
+	long long before = liveBytes;
+	clock_t st = clock();
+	Map *m = new Map;
+	if (reserved) reserve(*m, keys.size());
+	for (size_t i = 0; i < keys.size(); i++) (*m)[keys[i]] = i;
+	double buildTime = since(st);
+	double bytes = double(liveBytes - before) / m->size();
+
+	std::mt19937 gen(1);
+	const Map &cm = *m;
+	st = clock();
+	unsigned long long sum = 0;
+	for (size_t i = 0; i < keys.size(); i++) {
+		typename Map::const_iterator it = cm.find(keys[gen() % keys.size()]);
+		sum += it->second;
+	}
+	double findTime = since(st);
+	printf("%-22s %6.1f bytes/entry   build %6.3fs   find %6.3fs  [%llu]\n", name, bytes, buildTime, findTime, sum);
+	delete m;
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 10000000);
+	std::mt19937 gen(2021);
+	std::vector<unsigned> keys(n);
+	for (int i = 0; i < n; i++) keys[i] = gen();
+	printf("%d random unsigned -> unsigned entries\n", n);
+	bench<Map>("map", keys, false);
+	bench<Compact>("compact_map", keys, false);
+	bench<Compact>("compact_map reserved", keys, true);
+	return 0;
+}
@@ -0,0 +1,79 @@
+// Counts comparator calls per operation on a map-hash.cc style workload.
+// The baseline column is this bench built against the map.hpp that came before the
+// single-comparison descent (the repository's first commit); to measure it again,
+// put that map.hpp with its utility.hpp and exceptions.hpp in a directory and build
+// with it on the include path instead of map_submit.
+
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <string>
+#include "map.hpp"
+
+using namespace std;
+
+static long long cmpCount = 0;
+
+struct countingLess {
+	bool operator()(const string &a, const string &b) const {
+		cmpCount++;
+		return a < b;
+	}
+};
+
+default_random_engine myRandom(1021233);
+const int MaxL = 5;
+const int N = 100000;
+
+string randString() {
+	uniform_int_distribution<int> c('A', 'G');
+	uniform_int_distribution<int> length(1, MaxL);
+	string temS = "";
+	int l = length(myRandom);
+	for (int i = 0; i < l; ++i) temS += c(myRandom);
+	return temS;
+}
+
+//calls/op of the baseline map on this workload, which is deterministic
+const double baseline[4] = { 31.01, 27.39, 26.99, 36.89 };
+
+void report(const char *name, long long calls, int ops, clock_t st, double before) {
+	printf("%-12s %10lld calls  %6.2f calls/op  (baseline %6.2f)  %.3fs\n", name, calls, double(calls) / ops,
+		before, double(clock() - st) / CLOCKS_PER_SEC);
+}
+
+int main() {
+	sjtu::map<string, string, countingLess> trans;
+	string *keys = new string[N];
+	for (int i = 0; i < N; i++) keys[i] = randString();
+
+	cmpCount = 0;
+	clock_t st = clock();
+	for (int i = 0; i < N; i++) trans[keys[i]] = keys[(i + 1) % N];
+	report("operator[]", cmpCount, N, st, baseline[0]);
+
+	cmpCount = 0;
+	st = clock();
+	size_t hit = 0;
+	for (int i = 0; i < N; i++) hit += trans.count(randString());
+	report("count", cmpCount, N, st, baseline[1]);
+
+	cmpCount = 0;
+	st = clock();
+	for (int i = 0; i < N; i++)
+		if (trans.find(keys[i]) != trans.end()) hit += trans.at(keys[i]).size();
+	report("find+at", cmpCount, 2 * N, st, baseline[2]);
+
+	cmpCount = 0;
+	st = clock();
+	int erased = 0;
+	for (int i = 0; i < N; i += 2) {
+		sjtu::map<string, string, countingLess>::iterator it = trans.find(keys[i]);
+		if (it != trans.end()) { trans.erase(it); erased++; }
+	}
+	report("find+erase", cmpCount, N / 2, st, baseline[3]);
+
+	printf("size %d, checksum %d\n", (int)trans.size(), (int)(hit + erased));
+	delete[] keys;
+	return 0;
+}
@@ -0,0 +1,47 @@
+// Times deep copies, assignment and copy-on-write copies of a large sjtu::map.
+// usage: map-bench-copy [number of keys]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include "map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 2000000);
+	std::mt19937 gen(2017);
+	sjtu::map<unsigned, int> m;
+	for (int i = 0; i < n; i++) m[gen()] = i;
+	printf("%d keys\n", (int)m.size());
+
+	clock_t st = clock();
+	sjtu::map<unsigned, int> c(m);
+	double copyTime = since(st);
+
+	st = clock();
+	c = m;
+	double assignTime = since(st);
+
+	st = clock();
+	long long sum = 0;
+	for (sjtu::map<unsigned, int>::const_iterator it = c.cbegin(); it != c.cend(); ++it) sum += it->second;
+	double scanTime = since(st);
+	printf("copy %.3fs  assign %.3fs  scan of copy %.3fs  [%lld]\n", copyTime, assignTime, scanTime, sum);
+#ifndef NO_COW
+	m.set_copy_on_write(true);
+	st = clock();
+	for (int i = 0; i < 1000; i++) {
+		sjtu::map<unsigned, int> snapshot(m);
+		sum += snapshot.size();
+	}
+	double shareTime = since(st);
+	st = clock();
+	sjtu::map<unsigned, int> snapshot(m);
+	m[0] = 0;
+	double detachTime = since(st);
+	printf("1000 copy-on-write copies %.6fs  first write after a copy %.3fs  [%lld]\n", shareTime, detachTime, sum);
+#endif
+	return 0;
+}
@@ -0,0 +1,73 @@
+// Times erase while iterating, range erase and erase by key on sjtu::map.
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "map.hpp"
+
+static long long cmpCount = 0;
+
+struct countingLess {
+	bool operator()(const int &a, const int &b) const {
+		cmpCount++;
+		return a < b;
+	}
+};
+
+typedef sjtu::map<int, int, countingLess> Map;
+
+const int N = 1000000;
+
+void fill(Map &m) {
+	srand(2017);
+	for (int i = 0; i < N; i++) m[rand()] = i;
+}
+
+void report(const char *name, size_t erased, clock_t st) {
+	printf("%-16s %8d erased  %10lld compares  %.3fs\n", name, (int)erased, cmpCount,
+		double(clock() - st) / CLOCKS_PER_SEC);
+}
+
+int main() {
+	Map m;
+
+	//erase every other element while walking the map
+	fill(m);
+	size_t before = m.size();
+	cmpCount = 0;
+	clock_t st = clock();
+	Map::iterator it = m.begin();
+	while (it != m.end()) {
+		m.erase(it++);
+		if (it != m.end()) ++it;
+	}
+	report("erase(iterator)", before - m.size(), st);
+
+	//erase the middle half in one call
+	m.clear();
+	fill(m);
+	before = m.size();
+	Map::iterator first = m.begin(), last;
+	for (size_t i = 0; i < before / 4; i++) ++first;
+	last = first;
+	for (size_t i = 0; i < before / 2; i++) ++last;
+	cmpCount = 0;
+	st = clock();
+	m.erase(first, last);
+	report("erase(first,last)", before - m.size(), st);
+
+	//erase by key, half of which are absent
+	m.clear();
+	fill(m);
+	before = m.size();
+	cmpCount = 0;
+	st = clock();
+	size_t hit = 0;
+	srand(2017);
+	for (int i = 0; i < N; i++) {
+		hit += m.erase(rand());
+		rand();
+	}
+	report("erase(key)", hit, st);
+	return 0;
+}
@@ -0,0 +1,68 @@
+// Finds the sizes at which sjtu::flat_map beats sjtu::map: random lookups, a full
+// iteration, and building the map by inserting keys one at a time in random order.
+// every size runs about the same total number of operations.
+// usage: map-bench-flat [largest size] [operations per size]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "map.hpp"
+#include "flat_map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+struct result {
+	double find, iterate, insert;
+	unsigned long long sum;
+};
+
+template<class Map>
+result bench(const std::vector<unsigned> &keys, const std::vector<unsigned> &queries, long long ops) {
+	result r;
+	r.sum = 0;
+	int n = keys.size();
+	long long rounds = ops / n + 1;
+	clock_t st = clock();
+	for (long long t = 0; t < rounds; t++) {
+		Map m;
+		for (int i = 0; i < n; i++) m[keys[i]] = i;
+		r.sum += m.size();
+	}
+	r.insert = since(st) / (rounds * n) * 1e9;
+
+	Map m;
+	for (int i = 0; i < n; i++) m[keys[i]] = i;
+	const Map &cm = m;
+	st = clock();
+	for (long long t = 0, q = 0; t < ops; t++, q = (q + 1 == (long long)queries.size() ? 0 : q + 1)) {
+		typename Map::const_iterator it = cm.find(queries[q]);
+		if (it != cm.cend()) r.sum += it->second;
+	}
+	r.find = since(st) / ops * 1e9;
+
+	st = clock();
+	for (long long t = 0; t < rounds; t++)
+		for (typename Map::const_iterator it = cm.cbegin(); it != cm.cend(); ++it) r.sum += it->second;
+	r.iterate = since(st) / (rounds * n) * 1e9;
+	return r;
+}
+
+int main(int argc, char **argv) {
+	int maxN = (argc > 1 ? atoi(argv[1]) : 65536);
+	long long ops = (argc > 2 ? atoll(argv[2]) : 4000000);
+	std::mt19937 gen(2020);
+	printf("%8s | %-24s | %-24s | %-24s\n", "size", "find ns map/flat", "iterate ns map/flat", "insert ns map/flat");
+	for (int n = 4; n <= maxN; n *= 2) {
+		std::vector<unsigned> keys(n), queries(4096);
+		for (int i = 0; i < n; i++) keys[i] = gen();
+		for (size_t i = 0; i < queries.size(); i++) queries[i] = (i % 2 ? keys[gen() % n] : gen());
+		result a = bench<sjtu::map<unsigned, unsigned>>(keys, queries, ops);
+		result b = bench<sjtu::flat_map<unsigned, unsigned>>(keys, queries, ops);
+		printf("%8d | %7.1f %7.1f %7.2fx | %7.2f %7.2f %7.2fx | %7.1f %7.1f %7.2fx%s\n", n,
+			a.find, b.find, a.find / b.find, a.iterate, b.iterate, a.iterate / b.iterate,
+			a.insert, b.insert, a.insert / b.insert, a.sum == b.sum ? "" : "  [sums differ]");
+	}
+	return 0;
+}
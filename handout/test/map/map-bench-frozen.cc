@@ -0,0 +1,80 @@
+// Random lookups in an sjtu::map against the frozen_map made by freeze(), on
+// a map that fits in cache and on one far larger than the last-level cache,
+// and the heap bytes each keeps per entry.
+// usage: map-bench-frozen [number of keys] [number of lookups]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <random>
+#include <vector>
+#include "map.hpp"
+
+static long long allocBytes = 0;
+
+void *operator new(size_t n) {
+	allocBytes += n;
+	void *p = malloc(n);
+	if (p == NULL) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+typedef sjtu::map<unsigned, unsigned> Map;
+typedef sjtu::frozen_map<unsigned, unsigned> Frozen;
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+void bench(int n, int q) {
+	std::mt19937 gen(2019);
+	//nodes are allocated in random key order, so neighbours in the tree are far apart in memory
+	std::vector<sjtu::pair<unsigned, unsigned>> elements;
+	elements.reserve(n);
+	for (int i = 0; i < n; i++) elements.push_back(sjtu::pair<unsigned, unsigned>(gen() % (2u * n), i));
+	long long before = allocBytes;
+	Map m(elements.begin(), elements.end());
+	long long mapBytes = allocBytes - before;
+	before = allocBytes;
+	Frozen f = m.freeze();
+	long long frozenBytes = allocBytes - before;
+	std::vector<unsigned> keys(q);
+	for (int i = 0; i < q; i++) keys[i] = gen() % (2u * n);
+
+	const Map &cm = m;
+	clock_t st = clock();
+	unsigned long long sum = 0;
+	for (int i = 0; i < q; i++) {
+		Map::const_iterator it = cm.find(keys[i]);
+		if (it != cm.cend()) sum += it->second;
+	}
+	double mapTime = since(st);
+
+	st = clock();
+	unsigned long long sumFrozen = 0;
+	for (int i = 0; i < q; i++) {
+		Frozen::const_iterator it = f.find(keys[i]);
+		if (it != f.cend()) sumFrozen += it->second;
+	}
+	double frozenTime = since(st);
+
+	st = clock();
+	unsigned long long sumIter = 0;
+	for (Frozen::const_iterator it = f.cbegin(); it != f.cend(); ++it) sumIter += it->second;
+	double iterTime = since(st);
+
+	printf("%d keys, %d lookups\n", (int)m.size(), q);
+	printf("  find   map %.3fs (%.1f Mops/s)   frozen_map %.3fs (%.1f Mops/s)   %.2fx  [%llu %llu]\n",
+		mapTime, q / mapTime / 1e6, frozenTime, q / frozenTime / 1e6, mapTime / frozenTime, sum, sumFrozen);
+	printf("  bytes per entry   map %.1f   frozen_map %.1f   (in-order walk of frozen_map %.3fs [%llu])\n",
+		double(mapBytes) / m.size(), double(frozenBytes) / f.size(), iterTime, sumIter);
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 8000000);
+	int q = (argc > 2 ? atoi(argv[2]) : 4000000);
+	bench(n / 1000, q);
+	bench(n, q);
+	return 0;
+}
@@ -0,0 +1,62 @@
+// The map-hash.cc workload run against sjtu::map and sjtu::unordered_map.
+// usage: map-bench-hash [rounds]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string>
+#include "map.hpp"
+#include "unordered_map.hpp"
+
+using namespace std;
+
+const int MaxL = 5;
+const int N = 100000;
+
+string randString(default_random_engine &myRandom) {
+	uniform_int_distribution<int> c('A', 'G');
+	uniform_int_distribution<int> length(1, MaxL);
+	string temS = "";
+	int l = length(myRandom);
+	for (int i = 0; i < l; ++i) temS += c(myRandom);
+	return temS;
+}
+
+//returns a checksum of what map-hash.cc would print
+template<class BoolMap, class StringMap>
+unsigned long long run(int queries) {
+	default_random_engine myRandom(1021233);
+	BoolMap have;
+	StringMap trans;
+	for (int i = 1; i <= N; ++i) {
+		string english = randString(myRandom);
+		string foreign = randString(myRandom);
+		have[foreign] = true;
+		trans[foreign] = english;
+	}
+	unsigned long long sum = 0;
+	for (int i = 1; i <= queries; ++i) {
+		string s = randString(myRandom);
+		if (have[s]) sum = sum * 131 + trans[s].size() + (unsigned char)trans[s][0];
+		else sum = sum * 131 + 7;
+	}
+	return sum;
+}
+
+template<class BoolMap, class StringMap>
+void bench(const char *name, int rounds) {
+	unsigned long long sum = 0;
+	clock_t st = clock();
+	for (int r = 0; r < rounds; r++) sum ^= run<BoolMap, StringMap>(N);
+	double t = double(clock() - st) / CLOCKS_PER_SEC;
+	//every round does 2N inserts and N probe + N lookup operations
+	printf("%-14s %.3fs  %.2f Mops/s  checksum %llu\n", name, t, 4.0 * N * rounds / t / 1e6, sum);
+}
+
+int main(int argc, char **argv) {
+	int rounds = (argc > 1 ? atoi(argv[1]) : 5);
+	bench<sjtu::map<string, bool>, sjtu::map<string, string>>("map", rounds);
+	bench<sjtu::unordered_map<string, bool>, sjtu::unordered_map<string, string>>("unordered_map", rounds);
+	return 0;
+}
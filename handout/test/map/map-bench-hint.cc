@@ -0,0 +1,59 @@
+// Compares insert with and without a hint on sorted, reverse sorted and random streams.
+// usage: map-bench-hint [number of keys]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include "map.hpp"
+
+static long long cmpCount = 0;
+
+struct countingLess {
+	bool operator()(const int &a, const int &b) const {
+		cmpCount++;
+		return a < b;
+	}
+};
+
+typedef sjtu::map<int, int, countingLess> Map;
+typedef sjtu::pair<int, int> Pair;
+
+void report(const char *name, const char *how, int n, clock_t st) {
+	printf("%-8s %-22s %.3fs  %6.2f compares/insert\n", name, how, double(clock() - st) / CLOCKS_PER_SEC, double(cmpCount) / n);
+}
+
+//the hint is end() for the first insert and the last inserted element after that,
+//which is exact for descending keys and one step off for ascending ones
+void bench(const char *name, const int *key, int n) {
+	Map m1, m2, m3;
+	cmpCount = 0;
+	clock_t st = clock();
+	for (int i = 0; i < n; i++) m1.insert(Pair(key[i], i));
+	report(name, "insert(x)", n, st);
+
+	cmpCount = 0;
+	st = clock();
+	for (int i = 0; i < n; i++) m2.insert(m2.end(), Pair(key[i], i));
+	report(name, "insert(end(), x)", n, st);
+
+	cmpCount = 0;
+	st = clock();
+	Map::iterator last = m3.end();
+	for (int i = 0; i < n; i++) last = m3.emplace_hint(last, key[i], i);
+	report(name, "emplace_hint(last, x)", n, st);
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 1000000);
+	int *key = new int[n];
+	for (int i = 0; i < n; i++) key[i] = i;
+	bench("sorted", key, n);
+	for (int i = 0; i < n; i++) key[i] = n - i;
+	bench("reverse", key, n);
+	std::mt19937 gen(2017);
+	for (int i = 0; i < n; i++) key[i] = gen();
+	bench("random", key, n);
+	delete[] key;
+	return 0;
+}
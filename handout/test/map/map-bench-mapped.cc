@@ -0,0 +1,63 @@
+// Startup cost of rebuilding an sjtu::map from a text dump against opening the
+// image map::save() wrote as a mapped_map, for growing numbers of entries, and
+// the time of the first random lookups in each.
+// usage: map-bench-mapped [largest number of keys] [directory for the files]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string>
+#include "map.hpp"
+#include "mapped_map.hpp"
+
+typedef sjtu::map<unsigned, unsigned> Map;
+typedef sjtu::mapped_map<unsigned, unsigned> Mapped;
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+int main(int argc, char **argv) {
+	int maxN = (argc > 1 ? atoi(argv[1]) : 4000000);
+	std::string dir = (argc > 2 ? argv[2] : ".");
+	std::string text = dir + "/map-bench-mapped.txt", image = dir + "/map-bench-mapped.img";
+	const int lookups = 100000;
+	printf("%9s | %-28s | %-28s\n", "keys", "startup s: text/image", "first lookups s: map/image");
+	for (int n = 10000; n <= maxN; n *= 4) {
+		std::mt19937 gen(2022);
+		Map m;
+		for (int i = 0; i < n; i++) m[gen()] = i;
+		FILE *f = fopen(text.c_str(), "w");
+		for (Map::const_iterator it = m.cbegin(); it != m.cend(); ++it) fprintf(f, "%u %u\n", it->first, it->second);
+		fclose(f);
+		m.save(image.c_str());
+		m.clear();
+
+		clock_t st = clock();
+		Map loaded;
+		f = fopen(text.c_str(), "r");
+		unsigned k, v;
+		while (fscanf(f, "%u %u", &k, &v) == 2) loaded[k] = v;
+		fclose(f);
+		double textTime = since(st);
+
+		st = clock();
+		Mapped mapped(image.c_str());
+		double imageTime = since(st);
+
+		unsigned long long sum = 0, sumMapped = 0;
+		std::mt19937 q(1);
+		const Map &cl = loaded;
+		st = clock();
+		for (int i = 0; i < lookups; i++) sum += cl.count(q());
+		double mapFind = since(st);
+		q.seed(1);
+		st = clock();
+		for (int i = 0; i < lookups; i++) sumMapped += mapped.count(q());
+		double imageFind = since(st);
+		printf("%9d | %10.4f %10.6f %5.0fx | %10.4f %10.4f %5s\n", (int)loaded.size(), textTime, imageTime,
+			textTime / (imageTime > 1e-6 ? imageTime : 1e-6), mapFind, imageFind, sum == sumMapped ? "" : "[sums differ]");
+	}
+	remove(text.c_str());
+	remove(image.c_str());
+	return 0;
+}
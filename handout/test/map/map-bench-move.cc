@@ -0,0 +1,51 @@
+// Times moving sjtu::maps around: a growing vector of maps and sorting maps by size.
+// usage: map-bench-move [number of maps] [keys per map]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+typedef sjtu::map<unsigned, int> umap;
+
+int main(int argc, char **argv) {
+	int maps = (argc > 1 ? atoi(argv[1]) : 2000);
+	int keys = (argc > 2 ? atoi(argv[2]) : 1000);
+	std::mt19937 gen(2017);
+	umap proto;
+	for (int i = 0; i < keys; i++) proto[gen()] = i;
+	printf("%d maps of %d keys\n", maps, (int)proto.size());
+
+	//push_back moves every map over each time the vector grows
+	clock_t st = clock();
+	std::vector<umap> v;
+	for (int i = 0; i < maps; i++) {
+		v.push_back(proto);
+		v.back()[i] = i;
+	}
+	double growTime = since(st);
+
+	st = clock();
+	std::vector<umap> w;
+	w.reserve(maps);
+	for (int i = 0; i < maps; i++) w.push_back(proto);
+	double reservedTime = since(st);
+
+	//sorting swaps whole maps
+	std::vector<umap> s;
+	for (int i = 0; i < maps; i++) {
+		s.push_back(umap());
+		for (int j = gen() % 64; j > 0; j--) s.back()[gen()] = j;
+	}
+	st = clock();
+	std::sort(s.begin(), s.end(), [](const umap &a, const umap &b) { return a.size() < b.size(); });
+	double sortTime = since(st);
+	printf("push_back %.3fs  push_back into reserved %.3fs  sort by size %.3fs  [%d]\n",
+		growTime, reservedTime, sortTime, (int)(v.size() + w.size() + s[0].size()));
+	return 0;
+}
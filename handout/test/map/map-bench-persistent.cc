@@ -0,0 +1,61 @@
+// Keeps a snapshot of a map after every update, by copying an sjtu::map
+// and by taking versions of an sjtu::persistent_map.
+// usage: map-bench-persistent [number of keys] [number of updates]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "map.hpp"
+#include "persistent_map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 100000);
+	int updates = (argc > 2 ? atoi(argv[2]) : 200);
+	std::mt19937 gen(2017);
+	sjtu::map<int, int> m;
+	sjtu::persistent_map<int, int> p;
+	for (int i = 0; i < n; i++) {
+		int k = gen() % (2 * n);
+		m[k] = i;
+		p = p.insert_or_assign(k, i);
+	}
+	printf("%d keys, %d updates\n", (int)m.size(), updates);
+
+	clock_t st = clock();
+	{
+		std::vector<sjtu::map<int, int>> snapshots;
+		snapshots.reserve(updates);
+		for (int i = 0; i < updates; i++) {
+			m[gen() % (2 * n)] = i;
+			snapshots.push_back(m);
+		}
+	}
+	double copyTime = since(st);
+
+	st = clock();
+	{
+		std::vector<sjtu::persistent_map<int, int>> versions;
+		versions.reserve(updates);
+		for (int i = 0; i < updates; i++) {
+			p = p.insert_or_assign(gen() % (2 * n), i);
+			versions.push_back(p);
+		}
+	}
+	double versionTime = since(st);
+
+	st = clock();
+	long long sum = 0;
+	for (int i = 0; i < n; i++) sum += p.count(gen() % (2 * n));
+	double findTime = since(st);
+	st = clock();
+	for (int i = 0; i < n; i++) sum += static_cast<const sjtu::map<int, int> &>(m).count(gen() % (2 * n));
+	double mapFindTime = since(st);
+
+	printf("copy per update %.3fs  persistent version per update %.4fs\n", copyTime, versionTime);
+	printf("lookups: persistent_map %.3fs  map %.3fs  [%lld]\n", findTime, mapFindTime, sum);
+	return 0;
+}
@@ -0,0 +1,41 @@
+// Reads short key ranges out of a large sjtu::map with range(), against
+// scanning from begin() as before lower_bound existed.
+// usage: map-bench-range [number of keys] [range width]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include "map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 10000000);
+	unsigned width = (argc > 2 ? atoi(argv[2]) : 100);
+	std::mt19937 gen(2017);
+	sjtu::map<unsigned, int> m;
+	for (int i = 0; i < n; i++) m.insert(m.end(), sjtu::pair<const unsigned, int>(unsigned(i) * 4, i));
+	const sjtu::map<unsigned, int> &cm = m;
+	printf("%d keys, ranges of %u keys\n", (int)m.size(), width);
+
+	const int queries = 100000, scans = 5;
+	long long sum = 0;
+	clock_t st = clock();
+	for (int i = 0; i < queries; i++) {
+		unsigned lo = gen() % (4u * n);
+		for (const sjtu::map<unsigned, int>::value_type &x : cm.range(lo, lo + 4 * width)) sum += x.second;
+	}
+	double rangeTime = since(st);
+
+	st = clock();
+	for (int i = 0; i < scans; i++) {
+		unsigned lo = gen() % (4u * n), hi = lo + 4 * width;
+		for (sjtu::map<unsigned, int>::const_iterator it = cm.cbegin(); it != cm.cend() && it->first < hi; ++it)
+			if (it->first >= lo) sum += it->second;
+	}
+	double scanTime = since(st);
+	printf("per range: range() %.3fus  scan from begin() %.1fus  [%lld]\n",
+		rangeTime / queries * 1e6, scanTime / scans * 1e6, sum);
+	return 0;
+}
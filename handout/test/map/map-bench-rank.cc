@@ -0,0 +1,50 @@
+// nth, rank and iterator jumps on a large sjtu::map, against walking the thread.
+// usage: map-bench-rank [number of keys]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include "map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 10000000);
+	std::mt19937 gen(2017);
+	sjtu::map<unsigned, int> m;
+	clock_t st = clock();
+	for (int i = 0; i < n; i++) m[gen()] = i;
+	double insertTime = since(st);
+	const sjtu::map<unsigned, int> &cm = m;
+	size_t siz = m.size();
+	printf("%d keys, insert %.3fs\n", (int)siz, insertTime);
+
+	const int queries = 1000000, walks = 20;
+	long long sum = 0;
+	st = clock();
+	for (int i = 0; i < queries; i++) sum += cm.nth(gen() % siz)->second;
+	double nthTime = since(st);
+	st = clock();
+	for (int i = 0; i < queries; i++) sum += cm.rank(gen());
+	double rankTime = since(st);
+	st = clock();
+	sjtu::map<unsigned, int>::const_iterator it = cm.cbegin();
+	for (int i = 0; i < queries; i++) {
+		ptrdiff_t k = it - cm.cbegin(), step = gen() % 1000;
+		it += (k + step < (ptrdiff_t)siz ? step : -k);
+		sum += it->second;
+	}
+	double jumpTime = since(st);
+	st = clock();
+	for (int i = 0; i < walks; i++) {
+		size_t k = gen() % siz;
+		sjtu::map<unsigned, int>::const_iterator p = cm.cbegin();
+		for (size_t j = 0; j < k; j++) ++p;
+		sum += p->second;
+	}
+	double walkTime = since(st);
+	printf("per query: nth %.3fus  rank %.3fus  += %.3fus  walk to k-th %.1fus  [%lld]\n",
+		nthTime / queries * 1e6, rankTime / queries * 1e6, jumpTime / queries * 1e6, walkTime / walks * 1e6, sum);
+	return 0;
+}
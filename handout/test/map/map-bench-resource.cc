@@ -0,0 +1,57 @@
+// Times building and dropping sjtu::maps on the global heap and in a monotonic arena:
+// one large map, then many small ones as a tenant would hold.
+// usage: map-bench-resource [keys in the large map] [number of small maps]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <vector>
+#include "map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+typedef sjtu::map<unsigned, int> umap;
+
+void large(const char *name, sjtu::memory_resource *r, sjtu::monotonic_buffer_resource *arena, int n) {
+	std::mt19937 gen(2017);
+	clock_t st = clock();
+	umap *m = new umap(r);
+	for (int i = 0; i < n; i++) (*m)[gen()] = i;
+	double buildTime = since(st);
+	size_t sz = m->size();
+	st = clock();
+	delete m;
+	if (arena != NULL) arena->release();
+	printf("%-8s one map of %d keys: insert %.3fs  drop %.4fs\n", name, (int)sz, buildTime, since(st));
+}
+
+void small(const char *name, sjtu::memory_resource *r, sjtu::monotonic_buffer_resource *arena, int maps) {
+	std::mt19937 gen(2017);
+	clock_t st = clock();
+	std::vector<umap> *v = new std::vector<umap>;
+	v->reserve(maps);
+	for (int i = 0; i < maps; i++) {
+		v->push_back(umap(r));
+		for (int j = 0; j < 8; j++) v->back()[gen()] = j;
+	}
+	double buildTime = since(st);
+	size_t used = (arena != NULL ? arena->bytes_reserved() : 0);
+	st = clock();
+	delete v;
+	if (arena != NULL) arena->release();
+	printf("%-8s %d maps of 8 keys: insert %.3fs  drop %.4fs", name, maps, buildTime, since(st));
+	if (arena != NULL) printf("  arena %.1f MB", used / 1048576.0);
+	printf("\n");
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 2000000);
+	int maps = (argc > 2 ? atoi(argv[2]) : 200000);
+	sjtu::monotonic_buffer_resource arena(1 << 16);
+	large("new", sjtu::new_delete_resource(), NULL, n);
+	large("arena", &arena, &arena, n);
+	small("new", sjtu::new_delete_resource(), NULL, maps);
+	small("arena", &arena, &arena, maps);
+	return 0;
+}
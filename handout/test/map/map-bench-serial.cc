@@ -0,0 +1,77 @@
+// Throughput of map::serialize and map::deserialize to and from a buffer and a
+// stringstream, against writing the map as text with iostreams and reading it
+// back with one insert per element. the map is built by random inserts, so
+// walking it in key order jumps around memory and bounds the write speed.
+// usage: map-bench-serial [number of keys]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+template<class T>
+void bench(const char *name, const sjtu::map<unsigned, T> &m) {
+	typedef sjtu::map<unsigned, T> Map;
+	std::vector<char> buf;
+	clock_t st = clock();
+	m.serialize(buf);
+	double toBuffer = since(st);
+	double mb = buf.size() / 1e6;
+
+	std::ostringstream os;
+	st = clock();
+	m.serialize(os);
+	double toStream = since(st);
+	std::string bytes = os.str();
+
+	Map a, b;
+	st = clock();
+	a.deserialize(buf.data(), buf.size());
+	double fromBuffer = since(st);
+	std::istringstream is(bytes);
+	st = clock();
+	b.deserialize(is);
+	double fromStream = since(st);
+	//deserialize allocates nodes in key order, so writing a rebuilt map walks memory in order
+	std::vector<char> again;
+	st = clock();
+	a.serialize(again);
+	double rebuiltToBuffer = since(st);
+
+	std::ostringstream text;
+	st = clock();
+	for (typename Map::const_iterator it = m.cbegin(); it != m.cend(); ++it) text << it->first << ' ' << it->second << '\n';
+	double toText = since(st);
+	std::istringstream textIn(text.str());
+	Map c;
+	T v;
+	unsigned k;
+	st = clock();
+	while (textIn >> k >> v) c[k] = v;
+	double fromText = since(st);
+
+	printf("%s: %d elements, %.1f MB binary, %.1f MB text\n", name, (int)m.size(), mb, text.str().size() / 1e6);
+	printf("  write  buffer %7.1f MB/s   stream %7.1f MB/s   text %7.1f MB/s   rebuilt map to buffer %7.1f MB/s\n",
+		mb / toBuffer, mb / toStream, text.str().size() / 1e6 / toText, mb / rebuiltToBuffer);
+	printf("  read   buffer %7.1f MB/s   stream %7.1f MB/s   text %7.1f MB/s   [%d %d %d]\n",
+		mb / fromBuffer, mb / fromStream, text.str().size() / 1e6 / fromText, (int)a.size(), (int)b.size(), (int)c.size());
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 2000000);
+	std::mt19937 gen(2023);
+	sjtu::map<unsigned, unsigned> ints;
+	for (int i = 0; i < n; i++) ints[gen()] = i;
+	bench("unsigned -> unsigned", ints);
+	ints.clear();
+	sjtu::map<unsigned, std::string> strings;
+	for (int i = 0; i < n / 4; i++) strings[gen()] = std::string(8 + gen() % 25, 'a' + i % 26);
+	bench("unsigned -> string", strings);
+	return 0;
+}
@@ -0,0 +1,75 @@
+// A write-heavy mix of inserts, erases and finds on one map shared by 1, 2, 4, ...
+// threads: sjtu::map behind a mutex against sjtu::concurrent_skiplist_map.
+// usage: map-bench-skiplist [number of keys] [percent writes] [max threads]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "map.hpp"
+#include "concurrent_skiplist_map.hpp"
+
+const int opsPerThread = 500000;
+
+struct lockedMap {
+	sjtu::map<int, int> m;
+	std::mutex lock;
+	//the iterator is not to be used outside the lock
+	sjtu::pair<sjtu::map<int, int>::iterator, bool> insert(const sjtu::pair<const int, int> &x) {
+		std::lock_guard<std::mutex> g(lock);
+		return m.insert(x);
+	}
+	size_t erase(int k) {
+		std::lock_guard<std::mutex> g(lock);
+		return m.erase(k);
+	}
+	size_t count(int k) {
+		std::lock_guard<std::mutex> g(lock);
+		return m.count(k);
+	}
+};
+
+//million operations per second over all threads, wall clock
+template<class Map>
+double run(Map &m, int n, int writes, unsigned threads) {
+	std::vector<std::thread> pool;
+	std::atomic<size_t> sum(0);
+	std::chrono::steady_clock::time_point st = std::chrono::steady_clock::now();
+	for (unsigned t = 0; t < threads; t++) pool.push_back(std::thread([&, t]() {
+		std::mt19937 gen(t + 1);
+		size_t s = 0;
+		for (int i = 0; i < opsPerThread; i++) {
+			int k = gen() % (2 * n), op = gen() % 100;
+			if (op < writes / 2) s += m.insert(sjtu::pair<const int, int>(k, i)).second ? 1 : 0;
+			else if (op < writes) s += m.erase(k);
+			else s += m.count(k);
+		}
+		sum += s;
+	}));
+	for (unsigned t = 0; t < threads; t++) pool[t].join();
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - st).count();
+	return (double)opsPerThread * threads / s / 1e6;
+}
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 100000);
+	int writes = (argc > 2 ? atoi(argv[2]) : 50);
+	unsigned maxThreads = (argc > 3 ? atoi(argv[3]) : std::thread::hardware_concurrency());
+	if (maxThreads == 0) maxThreads = 1;
+	lockedMap a;
+	sjtu::concurrent_skiplist_map<int, int> b;
+	std::mt19937 gen(2017);
+	for (int i = 0; i < n; i++) {
+		int k = gen() % (2 * n);
+		a.insert(sjtu::pair<const int, int>(k, i));
+		b.insert(sjtu::pair<const int, int>(k, i));
+	}
+	printf("%d keys, %d%% writes, %d operations per thread\n", (int)b.size(), writes, opsPerThread);
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+		printf("%2u threads   map + mutex %6.2f Mops/s   concurrent_skiplist_map %6.2f Mops/s\n",
+			threads, run(a, n, writes, threads), run(b, n, writes, threads));
+	return 0;
+}
@@ -0,0 +1,44 @@
+// Moves the upper half of a large sjtu::map into another map and back, with
+// split/join and with erase and insert element by element.
+// usage: map-bench-split [number of keys] [rounds]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include "map.hpp"
+
+double since(clock_t st) { return double(clock() - st) / CLOCKS_PER_SEC; }
+
+int main(int argc, char **argv) {
+	int n = (argc > 1 ? atoi(argv[1]) : 1000000);
+	int rounds = (argc > 2 ? atoi(argv[2]) : 1000);
+	std::mt19937 gen(2017);
+	sjtu::map<unsigned, int> m;
+	for (int i = 0; i < n; i++) m[gen()] = i;
+	printf("%d keys\n", (int)m.size());
+
+	clock_t st = clock();
+	for (int r = 0; r < rounds; r++) {
+		sjtu::map<unsigned, int> upper = m.split(gen());
+		m.join(upper);
+	}
+	double splitTime = since(st);
+
+	st = clock();
+	for (int r = 0; r < 2; r++) {
+		unsigned key = gen();
+		sjtu::map<unsigned, int> upper;
+		sjtu::map<unsigned, int>::iterator it = m.lower_bound(key);
+		while (it != m.end()) {
+			upper.insert(upper.end(), *it);
+			m.erase(it++);
+		}
+		for (it = upper.begin(); it != upper.end(); ++it) m.insert(m.end(), *it);
+	}
+	double moveTime = since(st) / 2;
+
+	printf("per split and join: %.2fus   per element-wise move and back: %.3fs  [%d]\n",
+		splitTime / rounds * 1e6, moveTime, (int)m.size());
+	return 0;
+}
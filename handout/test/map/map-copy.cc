@@ -0,0 +1,120 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <string>
+#include "map.hpp"
+
+using namespace std;
+
+bool check1() { //a deep copy is equal and independent
+	sjtu::map<int, string> Q;
+	for (int i = 0; i < 50000; i++) Q[rand() % 100000] = to_string(i);
+	sjtu::map<int, string> P(Q);
+	if (P.size() != Q.size()) return 0;
+	sjtu::map<int, string>::const_iterator a = Q.cbegin(), b = P.cbegin();
+	for (; a != Q.cend(); ++a, ++b)
+		if (a->first != b->first || a->second != b->second || &a->second == &b->second) return 0;
+	if (b != P.cend()) return 0;
+	size_t n = Q.size();
+	P.clear();
+	for (int i = 0; i < 100; i++) P[i] = "x";
+	return P.size() == 100 && Q.size() == n && Q.cbegin()->second != "x";
+}
+
+bool check2() { //repeated assignment, also of empty maps and to itself
+	sjtu::map<int, int> Q, P, E;
+	for (int i = 0; i < 1000; i++) Q[i] = i;
+	for (int r = 0; r < 100; r++) {
+		P = Q;
+		P = P;
+		if (P.size() != 1000 || P[r] != r) return 0;
+		P = E;
+		if (!P.empty()) return 0;
+	}
+	return 1;
+}
+
+bool check3() { //copy-on-write copies share until one side writes
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 0; i < 20000; i++) { int a = rand(); Q[a] = i; stdQ[a] = i; }
+	Q.set_copy_on_write(true);
+	sjtu::map<int, int> P(Q), O;
+	O = P;
+	const sjtu::map<int, int> &cP = P, &cQ = Q;
+	if (&cP.cbegin()->second != &cQ.cbegin()->second) return 0;
+	P[-1] = 1;
+	if (&cP.cbegin()->second == &cQ.cbegin()->second || P.size() != Q.size() + 1) return 0;
+	Q.erase(Q.begin());
+	O.clear();
+	std::map<int, int>::iterator stdit = stdQ.begin();
+	if (P.count(stdit->first) != 1 || Q.count(stdit->first) != 0) return 0;
+	for (sjtu::map<int, int>::const_iterator it = cP.cbegin(); it != cP.cend(); ++it) {
+		if (it->first == -1) continue;
+		if (it->first != stdit->first || it->second != stdit->second) return 0;
+		++stdit;
+	}
+	return stdit == stdQ.end() && O.empty();
+}
+
+bool check4() { //iterators passed back to a shared map follow it to its own copy
+	sjtu::map<int, int> Q;
+	Q.set_copy_on_write(true);
+	for (int i = 0; i < 100; i++) Q[i] = i;
+	sjtu::map<int, int>::iterator first = Q.find(10), last = Q.find(20);
+	sjtu::map<int, int> P(Q);
+	Q.erase(first, last);
+	sjtu::map<int, int>::iterator hint = Q.end();
+	sjtu::map<int, int> O(Q);
+	Q.insert(hint, sjtu::pair<const int, int>(100, 100));
+	Q.set_copy_on_write(false);
+	sjtu::map<int, int> N(Q);
+	N[0] = -1;
+	return Q.size() == 91 && P.size() == 100 && O.size() == 90 && Q.count(15) == 0 && P.count(15) == 1
+		&& (--Q.end())->first == 100 && Q[0] == 0;
+}
+
+//counts the blocks a map asks for
+class countingResource : public sjtu::memory_resource {
+public:
+	size_t calls = 0;
+private:
+	void *do_allocate(size_t n, size_t) override {
+		calls++;
+		return ::operator new(n);
+	}
+	void do_deallocate(void *p, size_t, size_t) override { ::operator delete(p); }
+};
+
+bool check5() { //lookups that miss leave a shared tree shared, hits and steps back from end() copy it
+	countingResource r;
+	bool ok = true;
+	{
+		sjtu::map<int, int> Q(&r);
+		Q.set_copy_on_write(true);
+		for (int i = 0; i < 1000; i++) Q[2 * i] = i;
+		sjtu::map<int, int> P(Q);
+		size_t before = r.calls;
+		bool thrown = false;
+		try { Q.at(1); } catch (sjtu::index_out_of_bound &) { thrown = true; }
+		ok = ok && thrown && Q.find(1) == Q.end() && Q.end() == Q.find(3) && Q.erase(5) == 0;
+		ok = ok && Q.lower_bound(5000) == Q.end() && Q.upper_bound(1998) == Q.end() && Q.range(3000, 4000).empty();
+		ok = ok && r.calls == before && &Q.cbegin()->second == &P.cbegin()->second;
+		sjtu::map<int, int>::iterator last = Q.end();
+		(--last)->second = -1;
+		ok = ok && r.calls > before && last == --Q.end() && (--P.end())->second == 999;
+		sjtu::map<int, int> O(Q);
+		before = r.calls;
+		sjtu::map<int, int>::iterator it = Q.find(10);
+		it->second = -2;
+		ok = ok && r.calls > before && it->first == 10 && O[10] == 5 && P[10] == 5;
+		ok = ok && Q.erase(12) == 1 && O.count(12) == 1 && Q.size() == 999 && Q.at(14) == 7;
+	}
+	return ok;
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << " " << check5() << endl;
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <string>
+#include "map.hpp"
+
+using namespace std;
+
+//counts how often a mapped value is built, copied and moved
+struct Counted {
+	static int built, copies, moves;
+	int x;
+	Counted() : x(0) { built++; }
+	Counted(int x, int y) : x(x + y) { built++; }
+	Counted(const Counted &other) : x(other.x) { copies++; }
+	Counted(Counted &&other) : x(other.x) { moves++; }
+	static void reset() { built = copies = moves = 0; }
+};
+int Counted::built = 0, Counted::copies = 0, Counted::moves = 0;
+
+bool check1() { //operator[] builds a missing value exactly once
+	sjtu::map<int, Counted> Q;
+	Counted::reset();
+	for (int i = 0; i < 1000; i++) Q[i].x = i;
+	for (int i = 0; i < 1000; i++) Q[i].x += i;
+	if (Counted::built != 1000 || Counted::copies != 0 || Counted::moves != 0) return 0;
+	for (int i = 0; i < 1000; i++) if (Q.at(i).x != 2 * i) return 0;
+	return 1;
+}
+
+bool check2() { //try_emplace never touches the arguments of a present key
+	sjtu::map<string, Counted> Q;
+	Counted::reset();
+	for (int i = 0; i < 500; i++)
+		if (!Q.try_emplace(to_string(i), i, 1).second) return 0;
+	for (int i = 0; i < 500; i++)
+		if (Q.try_emplace(to_string(i), 0, 0).second) return 0;
+	if (Counted::built != 500 || Counted::copies != 0 || Counted::moves != 0) return 0;
+	for (int i = 0; i < 500; i++) if (Q[to_string(i)].x != i + 1) return 0;
+	return Q.size() == 500;
+}
+
+bool check3() { //insert of an rvalue moves instead of copying
+	sjtu::map<int, Counted> Q;
+	Counted::reset();
+	for (int i = 0; i < 100; i++)
+		if (!Q.insert(sjtu::map<int, Counted>::value_type(i, Counted(i, 0))).second) return 0;
+	if (Counted::copies != 0 || Counted::moves != 200) return 0;
+	Counted::reset();
+	if (Q.insert(sjtu::map<int, Counted>::value_type(5, Counted(0, 0))).second) return 0;
+	return Counted::copies == 0 && Counted::moves == 1 && Q[5].x == 5;
+}
+
+bool check4() { //emplace builds the pair in place and drops it on a duplicate key
+	sjtu::map<int, Counted> Q;
+	Counted::reset();
+	for (int i = 0; i < 100; i++)
+		if (!Q.emplace(std::piecewise_construct, std::forward_as_tuple(i), std::forward_as_tuple(i, 2)).second) return 0;
+	if (Q.emplace(std::piecewise_construct, std::forward_as_tuple(7), std::forward_as_tuple()).second) return 0;
+	if (Counted::built != 101 || Counted::copies != 0 || Counted::moves != 0) return 0;
+	sjtu::map<int, int> P;
+	P.emplace(1, 2);
+	P.emplace(1, 3);
+	return Q[7].x == 9 && Q.size() == 100 && P.size() == 1 && P[1] == 2;
+}
+
+bool check5() { //string keys are moved into the node
+	sjtu::map<string, int> Q;
+	string s(100, 'a');
+	Q[std::move(s)] = 1;
+	string t(100, 'b');
+	Q.try_emplace(std::move(t), 2);
+	return Q.size() == 2 && Q[string(100, 'a')] == 1 && Q[string(100, 'b')] == 2;
+}
+
+int main() {
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << " " << check5() << endl;
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include "map.hpp"
+
+using namespace std;
+
+//every heap allocation goes through here, so a test can check a move made none
+static long long allocCount = 0;
+void *operator new(size_t n) {
+	allocCount++;
+	void *p = malloc(n);
+	if (p == NULL) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+typedef sjtu::map<int, string> smap;
+
+bool same(const smap &m, int lo, int hi) { //m holds exactly lo..hi-1, each mapped to its string
+	if (m.size() != (size_t)(hi - lo)) return 0;
+	int k = lo;
+	for (smap::const_iterator it = m.cbegin(); it != m.cend(); ++it, ++k) {
+		if (it->first != k || it->second != to_string(k)) return 0;
+	}
+	return k == hi;
+}
+smap build(int lo, int hi) {
+	smap m;
+	for (int i = lo; i < hi; i++) m[i] = to_string(i);
+	return m;
+}
+
+bool check1() { //moving and swapping allocate nothing and keep the elements
+	static_assert(is_nothrow_move_constructible<smap>::value && is_nothrow_move_assignable<smap>::value, "noexcept move");
+	smap A = build(0, 5000), B = build(100, 200);
+	long long before = allocCount;
+	smap C(std::move(A));
+	B = std::move(C);
+	smap D = std::move(B);
+	D.swap(A);
+	swap(A, D);
+	swap(D, A);
+	if (allocCount != before) return 0;
+	return same(A, 0, 5000) && D.empty() && B.empty() && C.empty() && D.cbegin() == D.cend();
+}
+
+bool check2() { //a moved-from map can be used again
+	smap A = build(0, 1000);
+	smap B(std::move(A));
+	if (A.size() != 0 || A.count(5) || A.find(5) != A.end() || A.begin() != A.end()) return 0;
+	int thrown = 0;
+	try { A.at(3); } catch (...) { thrown++; }
+	for (int i = 10; i < 20; i++) A[i] = to_string(i);
+	smap C(std::move(B));
+	B.insert(sjtu::pair<const int, string>(7, "7"));
+	smap D(std::move(C));
+	C.clear();
+	smap E(std::move(D)), F(E);
+	D = F;
+	smap G(std::move(F));
+	F.erase(F.begin(), F.end());
+	return thrown == 1 && same(A, 10, 20) && same(B, 7, 8) && C.empty() && same(D, 0, 1000) && same(G, 0, 1000) && F.empty();
+}
+
+bool check3() { //copy-on-write maps move their share, and moved-from maps take it up again
+	smap A = build(0, 300);
+	A.set_copy_on_write(true);
+	smap B(A);
+	long long before = allocCount;
+	smap C(std::move(A));
+	if (allocCount != before) return 0;
+	C[1000] = "1000"; //the tree is still shared with B, so C copies it
+	if (!same(B, 0, 300) || C.size() != 301) return 0;
+	A.set_copy_on_write(true);
+	A[1] = "1";
+	smap D(A);
+	D[2] = "2";
+	smap E(std::move(B));
+	B.set_copy_on_write(false);
+	B[3] = "3";
+	return same(A, 1, 2) && D.size() == 2 && same(E, 0, 300) && same(B, 3, 4);
+}
+
+bool check4() { //containers and return values move maps instead of copying their nodes
+	vector<smap> v;
+	for (int i = 0; i < 50; i++) v.push_back(build(i, i + 100));
+	long long before = allocCount;
+	v.reserve(v.capacity() * 4); //one allocation, for the vector
+	if (allocCount != before + 1) return 0;
+	for (int i = 0; i < 50; i++) {
+		if (!same(v[i], i, i + 100)) return 0;
+	}
+	smap self = build(0, 10);
+	smap &ref = self;
+	self = std::move(ref);
+	return same(self, 0, 10);
+}
+
+int main() {
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << endl;
+	return 0;
+}
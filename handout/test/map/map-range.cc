@@ -0,0 +1,67 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include "map.hpp"
+
+using namespace std;
+
+bool check1() { //lower_bound and upper_bound against std::map
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 20000; i++) {
+		int a = rand() % 50000;
+		Q[a] = i; stdQ[a] = i;
+	}
+	const sjtu::map<int, int> &cQ = Q;
+	for (int i = -1; i <= 50001; i++) {
+		std::map<int, int>::iterator l = stdQ.lower_bound(i), u = stdQ.upper_bound(i);
+		sjtu::map<int, int>::iterator ql = Q.lower_bound(i), qu = Q.upper_bound(i);
+		sjtu::map<int, int>::const_iterator cl = cQ.lower_bound(i), cu = cQ.upper_bound(i);
+		if ((l == stdQ.end()) != (ql == Q.end()) || (u == stdQ.end()) != (qu == Q.end())) return 0;
+		if ((l == stdQ.end()) != (cl == cQ.cend()) || (u == stdQ.end()) != (cu == cQ.cend())) return 0;
+		if (l != stdQ.end() && (ql->first != l->first || cl->first != l->first)) return 0;
+		if (u != stdQ.end() && (qu->first != u->first || cu->first != u->first)) return 0;
+	}
+	return 1;
+}
+
+bool check2() { //equal_range
+	sjtu::map<int, int> Q;
+	for (int i = 0; i < 1000; i++) Q[i * 2] = i;
+	for (int i = -1; i <= 2000; i++) {
+		sjtu::pair<sjtu::map<int, int>::iterator, sjtu::map<int, int>::iterator> r = Q.equal_range(i);
+		if (i % 2 == 0 && i >= 0 && i < 2000) {
+			if (r.first->first != i || r.second - r.first != 1) return 0;
+		}
+		else if (r.first != r.second || r.first != Q.lower_bound(i)) return 0;
+	}
+	const sjtu::map<int, int> &cQ = Q;
+	return cQ.equal_range(10).first->second == 5 && cQ.equal_range(11).first == cQ.equal_range(11).second;
+}
+
+bool check3() { //range views
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 20000; i++) {
+		int a = rand() % 100000;
+		Q[a] = i; stdQ[a] = i;
+	}
+	for (int i = 0; i < 1000; i++) {
+		int lo = rand() % 100000, hi = lo + rand() % 500;
+		std::map<int, int>::iterator stdit = stdQ.lower_bound(lo);
+		size_t cnt = 0;
+		for (sjtu::map<int, int>::value_type &x : Q.range(lo, hi)) {
+			if (x.first != stdit->first || x.second != stdit->second) return 0;
+			++stdit; cnt++;
+		}
+		if (stdit != stdQ.lower_bound(hi) || Q.range(lo, hi).size() != cnt) return 0;
+	}
+	const sjtu::map<int, int> &cQ = Q;
+	return cQ.range(500, 100).empty() && cQ.range(100, 100).empty() && Q.range(-10, 200000).size() == Q.size();
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << endl;
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <iterator>
+#include "map.hpp"
+
+using namespace std;
+
+bool check1() { //nth and rank follow inserts and erases
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 30000; i++) {
+		int a = rand() % 10000;
+		if (i % 3 == 0) { Q.erase(a); stdQ.erase(a); }
+		else { Q[a] = i; stdQ[a] = i; }
+	}
+	int k = 0;
+	for (std::map<int, int>::iterator it = stdQ.begin(); it != stdQ.end(); ++it, ++k)
+		if (Q.nth(k)->first != it->first || Q.rank(it->first) != (size_t)k) return 0;
+	for (int i = 0; i < 10000; i += 7)
+		if (Q.rank(i) != (size_t)std::distance(stdQ.begin(), stdQ.lower_bound(i))) return 0;
+	return Q.rank(-1) == 0 && Q.rank(10000) == Q.size();
+}
+
+bool check2() { //iterator jumps and distances
+	sjtu::map<int, int> Q;
+	for (int i = 0; i < 5000; i++) Q[i * 3] = i;
+	sjtu::map<int, int>::iterator it = Q.begin();
+	for (int i = 0; i < 1000; i++) {
+		int step = rand() % 5000;
+		sjtu::map<int, int>::iterator jt = Q.begin() + step;
+		if (jt->second != step || jt - Q.begin() != step || Q.end() - jt != 5000 - step) return 0;
+		jt -= step / 2;
+		if (jt->second != step - step / 2) return 0;
+		it += (it->second < 2500 ? 1 : -1);
+	}
+	sjtu::map<int, int>::const_iterator c = Q.cbegin() + 4999;
+	if (c->first != 4999 * 3 || c + 1 != Q.cend() || Q.cend() - 5000 != Q.cbegin()) return 0;
+	return Q.end() - 5000 == Q.begin();
+}
+
+bool check3() { //sizes survive copies, assign and hinted inserts
+	sjtu::map<int, int> Q;
+	for (int i = 0; i < 2000; i++) Q.insert(Q.end(), sjtu::pair<const int, int>(i, i));
+	sjtu::map<int, int> P(Q), O;
+	O = P;
+	vector<sjtu::pair<int, int>> v;
+	for (int i = 0; i < 2000; i++) v.push_back(sjtu::pair<int, int>(rand() % 4000, i));
+	sjtu::map<int, int> R(v.begin(), v.end());
+	for (int i = 0; i < 2000; i += 13)
+		if (P.nth(i)->first != i || O.rank(i) != (size_t)i || Q.nth(i)->first != i) return 0;
+	for (size_t i = 0; i < R.size(); i++)
+		if (R.rank(R.nth(i)->first) != i) return 0;
+	return 1;
+}
+
+bool check4() { //exceptions
+	sjtu::map<int, int> Q;
+	int caught = 0;
+	try { Q.nth(0); } catch (...) { caught++; }
+	for (int i = 0; i < 10; i++) Q[i] = i;
+	try { Q.nth(10); } catch (...) { caught++; }
+	try { Q.begin() + 11; } catch (...) { caught++; }
+	try { Q.end() - 11; } catch (...) { caught++; }
+	sjtu::map<int, int> P(Q);
+	try { P.begin() - Q.begin(); } catch (...) { caught++; }
+	return caught == 5 && (Q.begin() + 10) == Q.end() && (Q.end() - 10) == Q.begin();
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << endl;
+	return 0;
+}
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <map>
+#include <cstdint>
+#include <string>
+#include "map_algebra.hpp"
+
+using namespace std;
+
+//hands memory on to new and checks each block comes back once, with its size and alignment
+class countingResource : public sjtu::memory_resource {
+public:
+	std::map<void *, pair<size_t, size_t>> live;
+	size_t bytes = 0, calls = 0, bad = 0;
+	~countingResource() { if (!live.empty()) bad++; }
+private:
+	void *do_allocate(size_t n, size_t align) override {
+		void *p = ::operator new(n);
+		if ((uintptr_t)p % align != 0) bad++;
+		live[p] = make_pair(n, align);
+		bytes += n;
+		calls++;
+		return p;
+	}
+	void do_deallocate(void *p, size_t n, size_t align) override {
+		auto it = live.find(p);
+		if (it == live.end() || it->second != make_pair(n, align)) { bad++; return; }
+		live.erase(it);
+		bytes -= n;
+		::operator delete(p);
+	}
+};
+
+typedef sjtu::map<int, long long> lmap;
+
+lmap build(sjtu::memory_resource *r, int lo, int hi) {
+	lmap m(r);
+	for (int i = lo; i < hi; i++) m[i] = (long long)i * i;
+	return m;
+}
+bool same(const lmap &m, int lo, int hi) {
+	if (m.size() != (size_t)(hi - lo)) return 0;
+	int k = lo;
+	for (lmap::const_iterator it = m.cbegin(); it != m.cend(); ++it, ++k) {
+		if (it->first != k || it->second != (long long)k * k) return 0;
+	}
+	return 1;
+}
+
+bool check1() { //every block of a map comes from its resource and goes back to it
+	countingResource r;
+	{
+		lmap m = build(&r, 0, 10000);
+		if (r.bytes < 10000 * sizeof(long long) || m.get_memory_resource() != &r) return 0;
+		for (int i = 0; i < 10000; i += 2) m.erase(i);
+		m.clear();
+		for (int i = 0; i < 500; i++) m[i] = (long long)i * i;
+		if (!same(m, 0, 500)) return 0;
+		lmap d;
+		if (d.get_memory_resource() != sjtu::new_delete_resource()) return 0;
+	}
+	return r.bytes == 0 && r.live.empty() && r.bad == 0;
+}
+
+bool check2() { //copies take the source's resource, assignment keeps the target's, moves and swaps carry it
+	countingResource r, s;
+	{
+		lmap a = build(&r, 0, 1000), b(a), c(a, &s), d(&s);
+		d = a;
+		if (b.get_memory_resource() != &r || c.get_memory_resource() != &s || d.get_memory_resource() != &s) return 0;
+		if (!same(b, 0, 1000) || !same(c, 0, 1000) || !same(d, 0, 1000)) return 0;
+		size_t rc = r.calls, sc = s.calls;
+		lmap e(std::move(d));
+		a.swap(c);
+		if (r.calls != rc || s.calls != sc) return 0;
+		if (e.get_memory_resource() != &s || d.get_memory_resource() != &s) return 0;
+		if (a.get_memory_resource() != &s || c.get_memory_resource() != &r) return 0;
+		d[1] = 1;
+		b = std::move(e);
+		if (b.get_memory_resource() != &s || !same(d, 1, 2) || !same(b, 0, 1000)) return 0;
+		lmap f = b.split(500);
+		if (f.get_memory_resource() != &s || !same(f, 500, 1000)) return 0;
+		lmap g = sjtu::map_union(f, c);
+		if (g.get_memory_resource() != &s || !same(g, 0, 1000)) return 0;
+	}
+	return r.live.empty() && s.live.empty() && r.bad == 0 && s.bad == 0;
+}
+
+bool check3() { //copy-on-write maps share only within one resource
+	countingResource r, s;
+	{
+		lmap a = build(&r, 0, 2000);
+		a.set_copy_on_write(true);
+		size_t before = r.calls;
+		lmap b(a);
+		if (r.calls != before) return 0;
+		lmap c(&s);
+		c = a; //copied into s, copy-on-write like a
+		if (s.bytes < 2000 * sizeof(long long)) return 0;
+		before = s.calls;
+		lmap d(c);
+		if (s.calls != before) return 0;
+		d[5000] = 0;
+		b[5000] = 0;
+		if (!same(a, 0, 2000) || !same(c, 0, 2000) || d.size() != 2001 || b.size() != 2001) return 0;
+	}
+	return r.live.empty() && s.live.empty() && r.bad == 0 && s.bad == 0;
+}
+
+bool check4() { //an arena serves many maps and gives its chunks back at once
+	countingResource up;
+	sjtu::monotonic_buffer_resource arena(1024, &up);
+	for (int round = 0; round < 3; round++) {
+		{
+			lmap maps[100];
+			for (int i = 0; i < 100; i++) {
+				lmap m = build(&arena, i, i + 50 + i * 10);
+				maps[i] = std::move(m);
+			}
+			for (int i = 0; i < 100; i++) {
+				if (!same(maps[i], i, i + 50 + i * 10)) return 0;
+			}
+			if (arena.bytes_allocated() == 0 || arena.bytes_reserved() < arena.bytes_allocated() || up.bytes != arena.bytes_reserved()) return 0;
+		}
+		arena.release();
+		if (up.bytes != 0 || arena.bytes_reserved() != 0) return 0;
+	}
+	void *p = arena.allocate(3, 1), *q = arena.allocate(100, 64), *big = arena.allocate(1 << 20, 8);
+	if ((uintptr_t)q % 64 != 0 || p == q || big == NULL) return 0;
+	arena.deallocate(q, 100, 64);
+	return arena.bytes_allocated() == 3 + 100 + (1 << 20) && up.bad == 0;
+}
+
+bool check5() { //maps built without a resource use the default one
+	countingResource r;
+	sjtu::memory_resource *old = sjtu::set_default_resource(&r);
+	{
+		lmap m;
+		m[1] = 1;
+		if (m.get_memory_resource() != &r || r.bytes == 0) return 0;
+	}
+	sjtu::set_default_resource(NULL);
+	return old == sjtu::new_delete_resource() && sjtu::get_default_resource() == old && r.live.empty();
+}
+
+struct alignas(128) wide {
+	int v;
+	wide(int x = 0) :v(x) {}
+};
+
+bool check6() { //over-aligned blocks keep their alignment on the default resource too
+	sjtu::memory_resource *r = sjtu::new_delete_resource();
+	for (size_t align = 1; align <= 4096; align *= 2) {
+		void *p = r->allocate(100, align);
+		if ((uintptr_t)p % align != 0) return 0;
+		r->deallocate(p, 100, align);
+	}
+	sjtu::map<int, wide> m;
+	for (int i = 0; i < 1000; i++) m[i] = wide(i);
+	for (int i = 0; i < 1000; i++) {
+		if ((uintptr_t)&m.at(i) % 128 != 0 || m.at(i).v != i) return 0;
+	}
+	return 1;
+}
+
+int main() {
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << " " << check5() << " " << check6() << endl;
+	return 0;
+}
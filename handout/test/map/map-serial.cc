@@ -0,0 +1,107 @@
+#include <iostream>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <string>
+#include "map.hpp"
+
+using namespace std;
+
+//a type that is not trivially copyable, written through a serial specialization
+struct tags {
+	vector<int> v;
+};
+namespace sjtu {
+	template<>
+	struct serial<tags> {
+		template<class Out> static void write(Out &out, const tags &t) {
+			out.putSize(t.v.size());
+			for (size_t i = 0; i < t.v.size(); i++) serial<int>::write(out, t.v[i]);
+		}
+		template<class In> static tags read(In &in) {
+			tags t;
+			for (uint64_t n = in.getSize(); n > 0; n--) t.v.push_back(serial<int>::read(in));
+			return t;
+		}
+	};
+}
+
+bool check1() { //round trips through streams and buffers
+	sjtu::map<int, double> Q, P, R;
+	for (int i = 0; i < 20000; i++) Q[rand() % 100000 - 50000] = i * 0.25;
+	stringstream ss;
+	Q.serialize(ss);
+	P.deserialize(ss);
+	vector<char> buf;
+	Q.serialize(buf);
+	if (R.deserialize(buf.data(), buf.size()) != buf.size()) return 0;
+	if (P.size() != Q.size() || R.size() != Q.size()) return 0;
+	sjtu::map<int, double>::const_iterator p = P.cbegin(), r = R.cbegin();
+	for (sjtu::map<int, double>::const_iterator q = Q.cbegin(); q != Q.cend(); ++q, ++p, ++r)
+		if (p->first != q->first || p->second != q->second || r->first != q->first || r->second != q->second) return 0;
+	for (int i = 0; i < 20000; i++) {//the rebuilt tree takes further changes
+		int a = rand() % 100000 - 50000;
+		if (i % 2) { P.erase(a); Q.erase(a); }
+		else { P[a] = i; Q[a] = i; }
+	}
+	return P.size() == Q.size() && P.rank(0) == Q.rank(0) && P.nth(P.size() / 2)->first == Q.nth(Q.size() / 2)->first;
+}
+
+bool check2() { //strings, custom types, and several maps in one stream
+	sjtu::map<string, string> S, S2;
+	sjtu::map<int, tags> T, T2;
+	for (int i = 0; i < 1000; i++) {
+		S[to_string(i * 13)] = string(i % 50, 'a' + i % 26);
+		tags &t = T[i];
+		for (int j = 0; j < i % 7; j++) t.v.push_back(i * j);
+	}
+	stringstream ss;
+	S.serialize(ss);
+	T.serialize(ss);
+	ss << "tail";
+	S2.deserialize(ss);
+	T2.deserialize(ss);
+	string rest;
+	ss >> rest;
+	if (rest != "tail" || S2.size() != 1000 || T2.size() != 1000) return 0;
+	if (S2.at("130") != string(10, 'k') || S2.at("0") != "" || T2.at(999).v.size() != 999 % 7 || T2.at(999).v[4] != 999 * 4) return 0;
+	vector<char> buf;
+	S.serialize(buf);
+	T.serialize(buf);
+	size_t used = S2.deserialize(buf.data(), buf.size());
+	return T2.deserialize(buf.data() + used, buf.size() - used) == buf.size() - used && S2.size() == 1000 && T2.at(6).v[5] == 30;
+}
+
+bool check3() { //truncated and unordered input throws and leaves the map empty
+	sjtu::map<int, string> Q, P;
+	for (int i = 0; i < 100; i++) Q[i] = to_string(i);
+	vector<char> buf;
+	Q.serialize(buf);
+	int thrown = 0;
+	P[1] = "x";
+	try { P.deserialize(buf.data(), buf.size() - 1); } catch (...) { thrown++; }
+	if (!P.empty()) return 0;
+	stringstream ss(string(buf.data(), buf.size() / 2));
+	try { P.deserialize(ss); } catch (...) { thrown++; }
+	if (!P.empty() || !ss.fail()) return 0;
+	vector<char> bad;
+	sjtu::map<int, string> A, B;
+	A[5] = "a";
+	B[3] = "b";
+	A.serialize(bad);
+	B.serialize(bad);
+	bad[0] = 2; //one map of two elements, keys 5 then 3
+	bad.erase(bad.begin() + 1 + sizeof(int) + 2);
+	try { P.deserialize(bad.data(), bad.size()); } catch (...) { thrown++; }
+	sjtu::map<int, string> E;
+	vector<char> empty;
+	E.serialize(empty);
+	return thrown == 3 && P.empty() && empty.size() == 1 && E.deserialize(empty.data(), 1) == 1;
+}
+
+int main() {
+	srand(2303);
+	cout << check1() << " " << check2() << " " << check3() << endl;
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <string>
+#include "map.hpp"
+
+using namespace std;
+
+template<class Map>
+bool same(sjtu::map<int, string> &Q, const Map &stdQ) {
+	if (Q.size() != stdQ.size()) return 0;
+	typename Map::const_iterator stdit = stdQ.begin();
+	for (sjtu::map<int, string>::iterator it = Q.begin(); it != Q.end(); ++it, ++stdit)
+		if (it->first != stdit->first || it->second != stdit->second) return 0;
+	if (stdit != stdQ.end()) return 0;
+	stdit = stdQ.end();
+	for (sjtu::map<int, string>::iterator it = Q.end(); it != Q.begin();)
+		if ((--it)->first != (--stdit)->first) return 0;
+	return 1;
+}
+
+bool check1() { //split at every kind of key and join back
+	sjtu::map<int, string> Q;
+	std::map<int, string> stdQ;
+	for (int i = 0; i < 20000; i++) {
+		int a = rand() % 40000;
+		Q[a] = to_string(i); stdQ[a] = to_string(i);
+	}
+	for (int i = 0; i < 200; i++) {
+		int k = rand() % 42000 - 1000;
+		sjtu::map<int, string> R = Q.split(k);
+		std::map<int, string> stdL(stdQ.begin(), stdQ.lower_bound(k)), stdR(stdQ.lower_bound(k), stdQ.end());
+		if (!same(Q, stdL) || !same(R, stdR)) return 0;
+		if (R.size() > 0 && (R.nth(0)->first != stdR.begin()->first || R.rank(k) != 0)) return 0;
+		Q.join(R);
+		if (!R.empty() || !same(Q, stdQ)) return 0;
+	}
+	return 1;
+}
+
+bool check2() { //the two halves live on independently
+	sjtu::map<int, string> Q;
+	for (int i = 0; i < 10000; i++) Q[i] = to_string(i);
+	sjtu::map<int, string> R = Q.split(5000);
+	for (int i = 0; i < 5000; i++) { Q.erase(i); R[i + 20000] = "x"; }
+	sjtu::map<int, string> P(R);
+	R.clear();
+	for (int i = 0; i < 1000; i++) Q[i] = "y";
+	return Q.size() == 1000 && P.size() == 10000 && P.at(5000) == "5000" && P.at(20000) == "x";
+}
+
+bool check3() { //merge keeps existing keys and leaves clashes behind
+	sjtu::map<int, string> Q, P, O;
+	std::map<int, string> stdQ, stdP;
+	for (int i = 0; i < 5000; i++) {
+		int a = rand() % 10000, b = rand() % 10000;
+		Q[a] = "q"; stdQ[a] = "q";
+		P[b] = "p"; stdP[b] = "p";
+	}
+	Q.merge(P);
+	for (std::map<int, string>::iterator it = stdP.begin(); it != stdP.end();) {
+		if (stdQ.insert(*it).second) stdP.erase(it++);
+		else ++it;
+	}
+	if (!same(Q, stdQ) || !same(P, stdP)) return 0;
+	for (int i = 0; i < 100; i++) O[-i - 1] = "o";
+	Q.merge(O);
+	for (int i = 0; i < 100; i++) stdQ[-i - 1] = "o";
+	return O.empty() && same(Q, stdQ);
+}
+
+bool check4() { //exceptions and empty maps
+	sjtu::map<int, string> Q, E;
+	for (int i = 0; i < 100; i++) Q[i] = "a";
+	sjtu::map<int, string> R = Q.split(50), S = Q.split(1000), T = E.split(0);
+	int caught = 0;
+	try { R.join(Q); } catch (...) { caught++; }
+	R.join(E);
+	E.join(R);
+	Q.join(E);
+	return caught == 1 && Q.size() == 100 && R.empty() && E.empty() && S.empty() && T.empty() && (Q.begin() + 99)->first == 99;
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << endl;
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include "map.hpp"
+#include "mapped_map.hpp"
+
+using namespace std;
+
+bool check1() { //an image serves the same lookups and iteration as the map it came from
+	sjtu::map<int, double> Q;
+	for (int i = 0; i < 50000; i++) Q[rand() % 200000] = i * 0.5;
+	Q.save("mapped-map-1.img");
+	bool ok = true;
+	{
+		sjtu::mapped_map<int, double> M("mapped-map-1.img");
+		const sjtu::map<int, double> &C = Q;
+		ok = M.size() == Q.size() && !M.empty();
+		for (int k = -1; k < 200001 && ok; k += 3) {
+			ok = M.count(k) == Q.count(k);
+			if (ok && M.count(k)) ok = M.at(k) == Q.at(k) && M[k] == Q.at(k) && M.find(k)->second == Q.at(k);
+			sjtu::map<int, double>::const_iterator lb = C.lower_bound(k);
+			sjtu::mapped_map<int, double>::const_iterator it = M.lower_bound(k);
+			if (ok) ok = (lb == C.cend()) == (it == M.cend()) && (it == M.cend() || it->first == lb->first);
+		}
+		sjtu::map<int, double>::const_iterator q = C.cbegin();
+		for (sjtu::mapped_map<int, double>::const_iterator it = M.cbegin(); it != M.cend() && ok; ++it, ++q)
+			ok = it->first == q->first && (*it).second == q->second;
+	}
+	remove("mapped-map-1.img");
+	return ok;
+}
+
+//string keys stored as fixed-size arrays, which compare like the strings they hold
+struct shortKey {
+	char s[16];
+};
+struct shortLess {
+	bool operator()(const shortKey &a, const shortKey &b) const { return strcmp(a.s, b.s) < 0; }
+};
+struct shortKeys {
+	typedef shortKey key_type;
+	typedef int mapped_type;
+	key_type key(const string &k) const {
+		shortKey x;
+		memset(x.s, 0, sizeof(x.s));
+		strncpy(x.s, k.c_str(), sizeof(x.s) - 1);
+		return x;
+	}
+	mapped_type value(const int &v) const { return v; }
+};
+
+bool check2() { //a serializer for types that are not trivially copyable
+	sjtu::map<string, int> Q;
+	for (int i = 0; i < 3000; i++) Q["key" + to_string(i * 7)] = i;
+	shortKeys enc;
+	Q.save("mapped-map-2.img", enc);
+	bool ok;
+	{
+		sjtu::mapped_map<shortKey, int, shortLess> M("mapped-map-2.img");
+		ok = M.size() == 3000 && M.at(enc.key("key70")) == 10 && M.count(enc.key("key71")) == 0;
+		sjtu::map<string, int>::const_iterator q = Q.cbegin();
+		for (sjtu::mapped_map<shortKey, int, shortLess>::const_iterator it = M.cbegin(); it != M.cend() && ok; ++it, ++q)
+			ok = q->first == it->first.s && q->second == it->second;
+	}
+	remove("mapped-map-2.img");
+	return ok;
+}
+
+bool check3() { //empty maps, and files that are not images of the map
+	sjtu::map<int, double> E;
+	E.save("mapped-map-3.img");
+	int thrown = 0;
+	{
+		sjtu::mapped_map<int, double> M("mapped-map-3.img");
+		if (!M.empty() || M.cbegin() != M.cend() || M.count(0) != 0) return 0;
+		try { M.at(0); } catch (...) { thrown++; }
+	}
+	try { sjtu::mapped_map<int, int> M("mapped-map-3.img"); } catch (...) { thrown++; }
+	try { sjtu::mapped_map<int, double> M("mapped-map-missing.img"); } catch (...) { thrown++; }
+	FILE *f = fopen("mapped-map-3.img", "ab");
+	fputc(0, f);
+	fclose(f);
+	try { sjtu::mapped_map<int, double> M("mapped-map-3.img"); } catch (...) { thrown++; }
+	remove("mapped-map-3.img");
+	return thrown == 4;
+}
+
+bool check4() { //offsets chosen so the sizes they span would wrap around are refused
+	sjtu::map<int, double> Q;
+	for (int i = 0; i < 100; i++) Q[i] = i;
+	Q.save("mapped-map-4.img");
+	FILE *f = fopen("mapped-map-4.img", "rb");
+	vector<char> image;
+	for (int c; (c = fgetc(f)) != EOF;) image.push_back((char)c);
+	fclose(f);
+	sjtu::mapImageHeader h;
+	memcpy(&h, image.data(), sizeof(h));
+	uint64_t keys = h.keysOffset, values = h.valuesOffset;
+	int thrown = 0;
+	for (int t = 0; t < 3; t++) {
+		h.keysOffset = keys;
+		h.valuesOffset = values;
+		if (t == 0) h.keysOffset = uint64_t(0) - 101 * sizeof(int) + sizeof(h) + 4;
+		if (t == 1) h.valuesOffset = h.fileSize + 8;
+		if (t == 2) h.keysOffset = h.valuesOffset + 4;
+		memcpy(image.data(), &h, sizeof(h));
+		f = fopen("mapped-map-4.img", "wb");
+		fwrite(image.data(), 1, image.size(), f);
+		fclose(f);
+		try { sjtu::mapped_map<int, double> M("mapped-map-4.img"); } catch (sjtu::runtime_error &) { thrown++; }
+	}
+	remove("mapped-map-4.img");
+	return thrown == 3;
+}
+
+int main() {
+	srand(2203);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << endl;
+	return 0;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <string>
+#include "persistent_map.hpp"
+
+using namespace std;
+
+typedef sjtu::persistent_map<int, int> P;
+
+template<class Map>
+bool same(const P &p, const Map &stdQ) {
+	if (p.size() != stdQ.size()) return 0;
+	typename Map::const_iterator stdit = stdQ.begin();
+	for (P::const_iterator it = p.cbegin(); it != p.cend(); ++it, ++stdit)
+		if (it->first != stdit->first || it->second != stdit->second) return 0;
+	return stdit == stdQ.end();
+}
+
+bool check1() { //insert and erase leave older versions alone
+	vector<P> versions(1);
+	vector<std::map<int, int>> stdVersions(1);
+	for (int i = 1; i <= 20000; i++) {
+		int a = rand() % 5000;
+		P v = (i % 3 == 0) ? versions.back().erase(a) : versions.back().insert(sjtu::pair<const int, int>(a, i));
+		std::map<int, int> stdv = stdVersions.back();
+		if (i % 3 == 0) stdv.erase(a);
+		else stdv.insert(std::pair<const int, int>(a, i));
+		versions.push_back(v);
+		stdVersions.push_back(stdv);
+	}
+	for (int i = 0; i <= 20000; i += 997)
+		if (!same(versions[i], stdVersions[i])) return 0;
+	return same(versions.back(), stdVersions.back());
+}
+
+bool check2() { //insert_or_assign, find, at, count
+	P p;
+	std::map<int, int> stdQ;
+	for (int i = 0; i < 10000; i++) {
+		int a = rand() % 3000;
+		p = p.insert_or_assign(a, i);
+		stdQ[a] = i;
+	}
+	for (int i = 0; i < 3000; i++) {
+		if (p.count(i) != stdQ.count(i)) return 0;
+		if (stdQ.count(i) && (p.at(i) != stdQ[i] || p.find(i)->second != stdQ[i] || p[i] != stdQ[i])) return 0;
+		if (!stdQ.count(i) && p.find(i) != p.cend()) return 0;
+	}
+	return same(p, stdQ);
+}
+
+bool check3() { //iterate both ways from anywhere
+	P p;
+	for (int i = 0; i < 1000; i++) p = p.insert(sjtu::pair<const int, int>(i * 2, i));
+	P::const_iterator it = p.find(500);
+	for (int i = 250; i < 1000; i++, ++it) if (it->first != i * 2) return 0;
+	if (it != p.cend()) return 0;
+	for (int i = 999; i >= 0; i--) if ((--it)->second != i) return 0;
+	return it == p.cbegin() && (*it).first == 0;
+}
+
+bool check4() { //copies are snapshots
+	P p;
+	for (int i = 0; i < 100; i++) p = p.insert(sjtu::pair<const int, int>(i, i));
+	P snapshot(p), other;
+	other = p;
+	for (int i = 0; i < 100; i += 2) p = p.erase(i);
+	p = p.insert_or_assign(1, -1);
+	return p.size() == 50 && snapshot.size() == 100 && other.size() == 100 && snapshot.at(1) == 1
+		&& other.count(0) == 1 && p.count(0) == 0 && p.at(1) == -1 && p.erase(1000).size() == 50;
+}
+
+bool check5() { //exceptions
+	P p;
+	int caught = 0;
+	try { p.at(1); } catch (...) { caught++; }
+	try { ++p.cend(); } catch (...) { caught++; }
+	try { --p.cend(); } catch (...) { caught++; }
+	p = p.insert(sjtu::pair<const int, int>(1, 1));
+	try { --p.cbegin(); } catch (...) { caught++; }
+	try { *p.cend(); } catch (...) { caught++; }
+	return caught == 5 && p.cbegin()->second == 1;
+}
+
+int main() {
+	srand(1701);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << " " << check5() << endl;
+	return 0;
+}
@@ -0,0 +1,174 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <string>
+#include "unordered_map.hpp"
+
+using namespace std;
+
+bool check1() { //insert, find, operator[]
+	sjtu::unordered_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 100000; i++) {
+		int a = rand() % 50000, b = rand();
+		if (i & 1) { Q[a] = b; stdQ[a] = b; }
+		else if (Q.insert(sjtu::pair<int, int>(a, b)).second != stdQ.insert(std::pair<int, int>(a, b)).second) return 0;
+	}
+	if (Q.size() != stdQ.size()) return 0;
+	for (int i = 0; i < 50000; i++) {
+		if (Q.count(i) != stdQ.count(i)) return 0;
+		if (stdQ.count(i) && (Q.find(i)->second != stdQ[i] || Q.at(i) != stdQ[i])) return 0;
+	}
+	return 1;
+}
+
+bool check2() { //iteration visits every element once
+	sjtu::unordered_map<string, int> Q;
+	std::map<string, int> stdQ;
+	for (int i = 1; i <= 30000; i++) {
+		string a = to_string(rand() % 20000);
+		Q[a] = i; stdQ[a] = i;
+	}
+	size_t n = 0;
+	for (sjtu::unordered_map<string, int>::iterator it = Q.begin(); it != Q.end(); ++it, ++n)
+		if (stdQ[it->first] != (*it).second) return 0;
+	if (n != stdQ.size()) return 0;
+	sjtu::unordered_map<string, int>::const_iterator cit = Q.cend();
+	for (n = 0; cit != Q.cbegin(); n++) --cit;
+	return n == stdQ.size();
+}
+
+bool check3() { //erase by key, by iterator and by range
+	sjtu::unordered_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for (int i = 1; i <= 50000; i++) {
+		int a = rand() % 20000;
+		Q[a] = i; stdQ[a] = i;
+		a = rand() % 20000;
+		if (Q.erase(a) != stdQ.erase(a)) return 0;
+		a = rand() % 20000;
+		if (Q.count(a)) { Q.erase(Q.find(a)); stdQ.erase(a); }
+	}
+	sjtu::unordered_map<int, int>::iterator l = Q.begin(), r;
+	for (int i = 0; i < 100; i++) ++l;
+	r = l;
+	for (int i = 0; i < 1000; i++) { stdQ.erase(r->first); ++r; }
+	Q.erase(l, r);
+	if (Q.size() != stdQ.size()) return 0;
+	for (std::map<int, int>::iterator it = stdQ.begin(); it != stdQ.end(); ++it)
+		if (!Q.count(it->first) || Q.at(it->first) != it->second) return 0;
+	return 1;
+}
+
+bool check4() { //copy, assignment and clear
+	sjtu::unordered_map<string, int> Q;
+	for (int i = 0; i < 10000; i++) Q[to_string(rand())] = i;
+	sjtu::unordered_map<string, int> P(Q), O;
+	O = P;
+	Q.clear();
+	if (!Q.empty() || Q.begin() != Q.end() || P.size() != O.size()) return 0;
+	for (sjtu::unordered_map<string, int>::const_iterator it = P.cbegin(); it != P.cend(); ++it)
+		if (O.at(it->first) != it->second) return 0;
+	return 1;
+}
+
+bool check5() { //exceptions
+	sjtu::unordered_map<int, int> Q;
+	int caught = 0;
+	try { Q.at(1); } catch (...) { caught++; }
+	try { Q.erase(Q.begin()); } catch (...) { caught++; }
+	Q[1] = 1;
+	try { --Q.begin(); } catch (...) { caught++; }
+	try { ++Q.end(); } catch (...) { caught++; }
+	try { Q.erase(Q.end()); } catch (...) { caught++; }
+	const sjtu::unordered_map<int, int> P(Q);
+	try { P[2]; } catch (...) { caught++; }
+	return caught == 6;
+}
+
+struct constantHash {
+	size_t operator()(int) const { return 7; }
+};
+
+bool check6() { //every key hashing alike makes one long cluster, which still works
+	sjtu::unordered_map<int, int, constantHash> Q;
+	for (int i = 0; i < 3000; i++) Q[i * 3] = i;
+	if (Q.size() != 3000) return 0;
+	for (int i = 0; i < 3000; i++) {
+		if (Q.at(i * 3) != i || Q.count(i * 3 + 1)) return 0;
+	}
+	for (int i = 0; i < 3000; i += 2) Q.erase(i * 3);
+	sjtu::unordered_map<int, int, constantHash> P(Q);
+	for (int i = 0; i < 3000; i++) {
+		if (P.count(i * 3) != (size_t)(i & 1) || (i & 1 && P.find(i * 3)->second != i)) return 0;
+	}
+	size_t n = 0;
+	for (sjtu::unordered_map<int, int, constantHash>::iterator it = P.begin(); it != P.end(); ++it) n++;
+	return n == 1500 && P.size() == 1500;
+}
+
+struct clusterHash {
+	size_t operator()(int x) const { return x % 16; }
+};
+
+bool check7() { //range erase over clusters that run past the range and wrap around the table
+	for (int round = 0; round < 200; round++) {
+		sjtu::unordered_map<int, int, clusterHash> Q;
+		std::map<int, int> stdQ;
+		int n = rand() % 3000;
+		for (int i = 0; i < n; i++) {
+			int a = rand();
+			Q[a] = i; stdQ[a] = i;
+		}
+		size_t from = (Q.size() == 0 ? 0 : rand() % (Q.size() + 1)), len = rand() % (Q.size() - from + 1);
+		sjtu::unordered_map<int, int, clusterHash>::iterator l = Q.begin(), r;
+		for (size_t i = 0; i < from; i++) ++l;
+		r = l;
+		for (size_t i = 0; i < len; i++) { stdQ.erase(r->first); ++r; }
+		Q.erase(l, r);
+		if (Q.size() != stdQ.size()) return 0;
+		for (std::map<int, int>::iterator it = stdQ.begin(); it != stdQ.end(); ++it)
+			if (Q.at(it->first) != it->second) return 0;
+	}
+	return 1;
+}
+
+//counts live copies and throws from the copy that brings throwIn to zero
+struct fragile {
+	static int live, throwIn;
+	int v;
+	fragile(int x = 0) :v(x) { live++; }
+	fragile(const fragile &o) :v(o.v) {
+		if (--throwIn == 0) throw 1;
+		live++;
+	}
+	fragile & operator=(const fragile &o) {
+		v = o.v;
+		return *this;
+	}
+	~fragile() { live--; }
+};
+int fragile::live = 0, fragile::throwIn = 0;
+
+bool check8() { //a copy that throws frees what it made and leaves the target alone
+	sjtu::unordered_map<int, fragile> Q, P;
+	for (int i = 0; i < 3000; i++) Q[i] = fragile(i);
+	for (int i = 0; i < 10; i++) P[-i] = fragile(i);
+	int before = fragile::live, caught = 0;
+	for (int k = 1; k < 3000; k += 499) {
+		fragile::throwIn = k;
+		try { sjtu::unordered_map<int, fragile> R(Q); } catch (...) { caught++; }
+		fragile::throwIn = k;
+		try { P = Q; } catch (...) { caught++; }
+		if (fragile::live != before || P.size() != 10 || P.at(-3).v != 3) return 0;
+	}
+	fragile::throwIn = 0;
+	return caught == 14;
+}
+
+int main() {
+	srand(1702);
+	cout << check1() << " " << check2() << " " << check3() << " " << check4() << " " << check5() << " " << check6()
+		<< " " << check7() << " " << check8() << endl;
+	return 0;
+}
@@ -0,0 +1,603 @@
+/**
+* a B+ tree with the interface of sjtu::map
+* keys are copied into the nodes so that a lookup only touches a few
+* cache lines per level; values live in separately allocated entries
+* so iterators stay valid while other elements move between nodes.
+* that is the price of sjtu::map's iterator rules (erase(it++) must work
+* although an erase shifts and merges leaves): lookups only read keys and
+* pay one pointer at the end, but a scan chases one pointer per value
+*/
+#ifndef SJTU_BTREE_MAP_HPP
+#define SJTU_BTREE_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+	template< class Key, class T, class Compare = std::less<Key>>
+	class btree_map {
+	public:
+		typedef pair<const Key, T> value_type;
+	private:
+		//a node takes about four cache lines
+		static const int nodeBytes = 256;
+		static const int leafCap = nodeBytes / (sizeof(Key) + sizeof(void *)) > 4 ? nodeBytes / (sizeof(Key) + sizeof(void *)) : 4;
+		static const int innerCap = nodeBytes / (sizeof(Key) + sizeof(void *)) > 4 ? nodeBytes / (sizeof(Key) + sizeof(void *)) : 4;
+		static const int minLeaf = leafCap / 2;
+		static const int minInner = innerCap / 2;
+
+		typedef typename std::aligned_storage<sizeof(Key), alignof(Key)>::type keyStorage;
+
+		struct leafNode;
+		struct innerNode;
+		struct entry {
+			typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage;
+			leafNode *leaf;
+			int pos;
+			value_type & data() { return *reinterpret_cast<value_type *>(&storage); }
+		};
+		struct nodeBase {
+			int cnt; //entries in a leaf, children in an inner node
+			bool isLeaf;
+			innerNode *parent;
+		};
+		//one spare slot lets a node overflow before it is split
+		struct leafNode : nodeBase {
+			keyStorage keys[leafCap + 1];
+			entry *vals[leafCap + 1];
+			leafNode *prev;
+			leafNode *next;
+			leafNode() :prev(NULL), next(NULL) { this->cnt = 0; this->isLeaf = true; this->parent = NULL; }
+			Key & key(int i) { return *reinterpret_cast<Key *>(keys + i); }
+		};
+		struct innerNode : nodeBase {
+			keyStorage keys[innerCap]; //keys[i] separates child[i] and child[i + 1]
+			nodeBase *child[innerCap + 1];
+			innerNode() { this->cnt = 0; this->isLeaf = false; this->parent = NULL; }
+			Key & key(int i) { return *reinterpret_cast<Key *>(keys + i); }
+		};
+
+		nodeBase *root;
+		leafNode *first;
+		leafNode *last;
+		Compare compare;
+		size_t siz;
+
+	public:
+		class const_iterator;
+		class iterator {
+		public:
+			entry *it;
+			btree_map<Key, T, Compare> *mPtr;
+			iterator() { it = NULL; mPtr = NULL; }
+			iterator(btree_map<Key, T, Compare> &m, entry *p = NULL) { mPtr = &m; it = p; }
+			iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
+			iterator & operator=(const iterator &other) {
+				it = other.it;
+				mPtr = other.mPtr;
+				return *this;
+			}
+			iterator operator++(int) {
+				iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			iterator & operator++() {
+				if (it == NULL) throw invalid_iterator();
+				it = mPtr->nextEntry(it);
+				return *this;
+			}
+			iterator operator--(int) {
+				iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			iterator & operator--() {
+				entry *p = mPtr->prevEntry(it);
+				if (p == NULL) throw invalid_iterator();
+				it = p;
+				return *this;
+			}
+			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			value_type & operator*() const {
+				if (it == NULL) throw invalid_iterator();
+				else return it->data();
+			}
+			value_type* operator->() const noexcept { return &(it->data()); }
+		};
+		class const_iterator {
+		public:
+			entry *it;
+			const btree_map<Key, T, Compare> *mPtr;
+			const_iterator() { it = NULL; mPtr = NULL; }
+			const_iterator(const btree_map<Key, T, Compare> &m, entry *p = NULL) { mPtr = &m; it = p; }
+			const_iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
+			const_iterator(const const_iterator &other) { it = other.it; mPtr = other.mPtr; }
+			const_iterator & operator=(const const_iterator &other) {
+				it = other.it;
+				mPtr = other.mPtr;
+				return *this;
+			}
+			const_iterator operator++(int) {
+				const_iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (it == NULL) throw invalid_iterator();
+				it = mPtr->nextEntry(it);
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				entry *p = mPtr->prevEntry(it);
+				if (p == NULL) throw invalid_iterator();
+				it = p;
+				return *this;
+			}
+			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			value_type & operator*() const {
+				if (it == NULL) throw invalid_iterator();
+				else return it->data();
+			}
+			value_type* operator->() const noexcept { return &(it->data()); }
+		};
+		btree_map() {
+			root = NULL;
+			first = last = NULL;
+			siz = 0;
+		}
+		btree_map(const btree_map &other) {
+			root = NULL;
+			first = last = NULL;
+			siz = 0;
+			copyFrom(other);
+		}
+		//this map is left as it was if copying throws
+		btree_map & operator=(const btree_map &other) {
+			if (this == &other) return *this;
+			btree_map tmp(other);
+			std::swap(root, tmp.root);
+			std::swap(first, tmp.first);
+			std::swap(last, tmp.last);
+			std::swap(siz, tmp.siz);
+			return *this;
+		}
+		~btree_map() { clear(); }
+		T & at(const Key &key) {
+			entry *e = findEntry(key);
+			if (e != NULL) return e->data().second;
+			else throw index_out_of_bound();
+		}
+		const T & at(const Key &key) const {
+			entry *e = findEntry(key);
+			if (e != NULL) return e->data().second;
+			else throw index_out_of_bound();
+		}
+		T & operator[](const Key &key) {
+			entry *e = findEntry(key);
+			if (e != NULL) return e->data().second;
+			pair<iterator, bool> ans = this->insert(value_type(key, T()));
+			return ans.first.it->data().second;
+		}
+		const T & operator[](const Key &key) const {
+			entry *e = findEntry(key);
+			if (e != NULL) return e->data().second;
+			else throw index_out_of_bound();
+		}
+		iterator begin() { return iterator(*this, siz == 0 ? NULL : first->vals[0]); }
+		const_iterator cbegin() const { return const_iterator(*this, siz == 0 ? NULL : first->vals[0]); }
+		iterator end() { return iterator(*this); }
+		const_iterator cend() const { return const_iterator(*this); }
+		bool empty() const { return siz == 0; }
+		size_t size() const { return siz; }
+		void clear() {
+			if (root != NULL) destroyNode(root);
+			root = NULL;
+			first = last = NULL;
+			siz = 0;
+		}
+		pair<iterator, bool> insert(const value_type &x) {
+			if (root == NULL) {
+				first = last = new leafNode;
+				root = first;
+			}
+			leafNode *leaf = findLeaf(x.first);
+			int i = lowerIndex(leaf, x.first);
+			if (i < leaf->cnt && !compare(x.first, leaf->key(i)))
+				return pair<iterator, bool>(iterator(*this, leaf->vals[i]), false);
+
+			entry *e = newEntry(x);
+			shiftKeys(leaf->keys, i, leaf->cnt, 1);
+			try { new (leaf->keys + i) Key(x.first); }
+			catch (...) {
+				shiftKeys(leaf->keys, i + 1, leaf->cnt + 1, -1);
+				destroyEntry(e);
+				throw;
+			}
+			for (int j = leaf->cnt; j > i; j--) setVal(leaf, j, leaf->vals[j - 1]);
+			setVal(leaf, i, e);
+			leaf->cnt++;
+			siz++;
+			if (leaf->cnt > leafCap) splitLeaf(leaf);
+			return pair<iterator, bool>(iterator(*this, e), true);
+		}
+		void erase(iterator pos) {
+			if (this->empty()) throw invalid_iterator();
+			if (pos.mPtr != this) throw invalid_iterator();
+			if (pos == this->end()) throw index_out_of_bound();
+			eraseEntry(pos.it);
+		}
+		void erase(iterator first, iterator last) {
+			if (first.mPtr != this || last.mPtr != this) throw invalid_iterator();
+			while (first.it != last.it) {
+				if (first.it == NULL) throw invalid_iterator();
+				entry *e = first.it;
+				first.it = nextEntry(e);
+				eraseEntry(e);
+			}
+		}
+		size_t erase(const Key &key) {
+			entry *e = findEntry(key);
+			if (e == NULL) return 0;
+			eraseEntry(e);
+			return 1;
+		}
+		size_t count(const Key &key) const {
+			if (findEntry(key) == NULL) return 0;
+			else return 1;
+		}
+		iterator find(const Key &key) {
+			entry *e = findEntry(key);
+			if (e == NULL) return this->end();
+			else return iterator(*this, e);
+		}
+		const_iterator find(const Key &key) const {
+			entry *e = findEntry(key);
+			if (e == NULL) return this->cend();
+			else return const_iterator(*this, e);
+		}
+
+	private:
+		entry *nextEntry(entry *e) const {
+			if (e->pos + 1 < e->leaf->cnt) return e->leaf->vals[e->pos + 1];
+			if (e->leaf->next != NULL) return e->leaf->next->vals[0];
+			return NULL;
+		}
+		entry *prevEntry(entry *e) const {//NULL at begin()
+			if (e == NULL) return (siz == 0 ? NULL : last->vals[last->cnt - 1]);
+			if (e->pos > 0) return e->leaf->vals[e->pos - 1];
+			if (e->leaf->prev != NULL) return e->leaf->prev->vals[e->leaf->prev->cnt - 1];
+			return NULL;
+		}
+		//first child whose range may hold key
+		int childIndex(innerNode *p, const Key &key) const {
+			int l = 0, r = p->cnt - 1;
+			while (l < r) {
+				int mid = (l + r) / 2;
+				if (compare(key, p->key(mid))) r = mid;
+				else l = mid + 1;
+			}
+			return l;
+		}
+		int lowerIndex(leafNode *leaf, const Key &key) const {
+			int l = 0, r = leaf->cnt;
+			while (l < r) {
+				int mid = (l + r) / 2;
+				if (compare(leaf->key(mid), key)) l = mid + 1;
+				else r = mid;
+			}
+			return l;
+		}
+		leafNode *findLeaf(const Key &key) const {
+			nodeBase *p = root;
+			while (!p->isLeaf) {
+				innerNode *q = static_cast<innerNode *>(p);
+				p = q->child[childIndex(q, key)];
+			}
+			return static_cast<leafNode *>(p);
+		}
+		entry *findEntry(const Key &key) const {
+			if (root == NULL) return NULL;
+			leafNode *leaf = findLeaf(key);
+			int i = lowerIndex(leaf, key);
+			if (i < leaf->cnt && !compare(key, leaf->key(i))) return leaf->vals[i];
+			return NULL;
+		}
+		int indexInParent(nodeBase *p) const {
+			innerNode *q = p->parent;
+			int i = 0;
+			while (q->child[i] != p) i++;
+			return i;
+		}
+
+		//keys are moved by copy-and-destroy since Key need not be assignable
+		static void moveKey(keyStorage *to, keyStorage *from) {
+			new (to) Key(*reinterpret_cast<Key *>(from));
+			reinterpret_cast<Key *>(from)->~Key();
+		}
+		//move keys[l, r) by d slots, the destination slots must be empty
+		static void shiftKeys(keyStorage *keys, int l, int r, int d) {
+			if (d > 0) for (int i = r - 1; i >= l; i--) moveKey(keys + i + d, keys + i);
+			else for (int i = l; i < r; i++) moveKey(keys + i + d, keys + i);
+		}
+		static void replaceKey(keyStorage *to, const Key &key) {
+			reinterpret_cast<Key *>(to)->~Key();
+			new (to) Key(key);
+		}
+		static void setVal(leafNode *leaf, int i, entry *e) {
+			leaf->vals[i] = e;
+			e->leaf = leaf;
+			e->pos = i;
+		}
+		static void setChild(innerNode *p, int i, nodeBase *c) {
+			p->child[i] = c;
+			c->parent = p;
+		}
+		static entry *newEntry(const value_type &x) {
+			entry *e = static_cast<entry *>(::operator new(sizeof(entry)));
+			try { new (&e->storage) value_type(x); }
+			catch (...) { ::operator delete(e); throw; }
+			return e;
+		}
+		static void destroyEntry(entry *e) {
+			e->data().~value_type();
+			::operator delete(e);
+		}
+
+		void splitLeaf(leafNode *leaf) {
+			leafNode *right = new leafNode;
+			int lc = leaf->cnt / 2;
+			for (int i = lc; i < leaf->cnt; i++) {
+				moveKey(right->keys + i - lc, leaf->keys + i);
+				setVal(right, i - lc, leaf->vals[i]);
+			}
+			right->cnt = leaf->cnt - lc;
+			leaf->cnt = lc;
+			right->next = leaf->next;
+			right->prev = leaf;
+			if (leaf->next != NULL) leaf->next->prev = right;
+			else last = right;
+			leaf->next = right;
+			insertChild(leaf, right->key(0), right);
+		}
+		//link right after left in left's parent with separator key
+		void insertChild(nodeBase *left, const Key &key, nodeBase *right) {
+			innerNode *p = left->parent;
+			if (p == NULL) {
+				p = new innerNode;
+				new (p->keys) Key(key);
+				setChild(p, 0, left);
+				setChild(p, 1, right);
+				p->cnt = 2;
+				root = p;
+				return;
+			}
+			int i = indexInParent(left);
+			shiftKeys(p->keys, i, p->cnt - 1, 1);
+			new (p->keys + i) Key(key);
+			for (int j = p->cnt; j > i + 1; j--) p->child[j] = p->child[j - 1];
+			setChild(p, i + 1, right);
+			p->cnt++;
+			if (p->cnt > innerCap) splitInner(p);
+		}
+		void splitInner(innerNode *p) {
+			innerNode *q = new innerNode;
+			int lc = p->cnt / 2;
+			for (int i = lc; i < p->cnt; i++) setChild(q, i - lc, p->child[i]);
+			for (int i = lc; i < p->cnt - 1; i++) moveKey(q->keys + i - lc, p->keys + i);
+			q->cnt = p->cnt - lc;
+			p->cnt = lc;
+			//keys[lc - 1] moves up to the parent
+			insertChild(p, p->key(lc - 1), q);
+			p->key(lc - 1).~Key();
+		}
+
+		void eraseEntry(entry *e) {
+			leafNode *leaf = e->leaf;
+			int i = e->pos;
+			leaf->key(i).~Key();
+			shiftKeys(leaf->keys, i + 1, leaf->cnt, -1);
+			for (int j = i + 1; j < leaf->cnt; j++) setVal(leaf, j - 1, leaf->vals[j]);
+			leaf->cnt--;
+			siz--;
+			destroyEntry(e);
+			if (leaf == root) {
+				if (leaf->cnt == 0) {
+					delete leaf;
+					root = NULL;
+					first = last = NULL;
+				}
+				return;
+			}
+			if (leaf->cnt < minLeaf) fixLeaf(leaf);
+		}
+		void fixLeaf(leafNode *leaf) {
+			innerNode *p = leaf->parent;
+			int i = indexInParent(leaf);
+			leafNode *l = (i > 0 ? static_cast<leafNode *>(p->child[i - 1]) : NULL);
+			leafNode *r = (i + 1 < p->cnt ? static_cast<leafNode *>(p->child[i + 1]) : NULL);
+			if (l != NULL && l->cnt > minLeaf) {//borrow the last entry of the left sibling
+				shiftKeys(leaf->keys, 0, leaf->cnt, 1);
+				for (int j = leaf->cnt; j > 0; j--) setVal(leaf, j, leaf->vals[j - 1]);
+				moveKey(leaf->keys, l->keys + l->cnt - 1);
+				setVal(leaf, 0, l->vals[l->cnt - 1]);
+				leaf->cnt++;
+				l->cnt--;
+				replaceKey(p->keys + i - 1, leaf->key(0));
+			}
+			else if (r != NULL && r->cnt > minLeaf) {//borrow the first entry of the right sibling
+				moveKey(leaf->keys + leaf->cnt, r->keys);
+				setVal(leaf, leaf->cnt, r->vals[0]);
+				leaf->cnt++;
+				shiftKeys(r->keys, 1, r->cnt, -1);
+				for (int j = 1; j < r->cnt; j++) setVal(r, j - 1, r->vals[j]);
+				r->cnt--;
+				replaceKey(p->keys + i, r->key(0));
+			}
+			else if (l != NULL) {
+				mergeLeaf(l, leaf);
+				removeChild(p, i - 1, i);
+			}
+			else {
+				mergeLeaf(leaf, r);
+				removeChild(p, i, i + 1);
+			}
+		}
+		//append r to l and free r
+		void mergeLeaf(leafNode *l, leafNode *r) {
+			for (int j = 0; j < r->cnt; j++) {
+				moveKey(l->keys + l->cnt + j, r->keys + j);
+				setVal(l, l->cnt + j, r->vals[j]);
+			}
+			l->cnt += r->cnt;
+			l->next = r->next;
+			if (r->next != NULL) r->next->prev = l;
+			else last = l;
+			delete r;
+		}
+		//drop key k and child c from p, then fix p
+		void removeChild(innerNode *p, int k, int c) {
+			p->key(k).~Key();
+			shiftKeys(p->keys, k + 1, p->cnt - 1, -1);
+			for (int j = c + 1; j < p->cnt; j++) p->child[j - 1] = p->child[j];
+			p->cnt--;
+			if (p == root) {
+				if (p->cnt == 1) {
+					root = p->child[0];
+					root->parent = NULL;
+					delete p;
+				}
+				return;
+			}
+			if (p->cnt < minInner) fixInner(p);
+		}
+		void fixInner(innerNode *p) {
+			innerNode *g = p->parent;
+			int i = indexInParent(p);
+			innerNode *l = (i > 0 ? static_cast<innerNode *>(g->child[i - 1]) : NULL);
+			innerNode *r = (i + 1 < g->cnt ? static_cast<innerNode *>(g->child[i + 1]) : NULL);
+			if (l != NULL && l->cnt > minInner) {//rotate through the separator in g
+				shiftKeys(p->keys, 0, p->cnt - 1, 1);
+				for (int j = p->cnt; j > 0; j--) p->child[j] = p->child[j - 1];
+				moveKey(p->keys, g->keys + i - 1);
+				setChild(p, 0, l->child[l->cnt - 1]);
+				moveKey(g->keys + i - 1, l->keys + l->cnt - 2);
+				p->cnt++;
+				l->cnt--;
+			}
+			else if (r != NULL && r->cnt > minInner) {
+				moveKey(p->keys + p->cnt - 1, g->keys + i);
+				setChild(p, p->cnt, r->child[0]);
+				moveKey(g->keys + i, r->keys);
+				shiftKeys(r->keys, 1, r->cnt - 1, -1);
+				for (int j = 1; j < r->cnt; j++) r->child[j - 1] = r->child[j];
+				p->cnt++;
+				r->cnt--;
+			}
+			else if (l != NULL) {
+				mergeInner(l, p, g->key(i - 1));
+				removeChild(g, i - 1, i);
+			}
+			else {
+				mergeInner(p, r, g->key(i));
+				removeChild(g, i, i + 1);
+			}
+		}
+		//append the separator and r to l and free r
+		void mergeInner(innerNode *l, innerNode *r, const Key &key) {
+			new (l->keys + l->cnt - 1) Key(key);
+			for (int j = 0; j < r->cnt - 1; j++) moveKey(l->keys + l->cnt + j, r->keys + j);
+			for (int j = 0; j < r->cnt; j++) setChild(l, l->cnt + j, r->child[j]);
+			l->cnt += r->cnt;
+			delete r;
+		}
+
+		void destroyNode(nodeBase *p) {
+			if (p->isLeaf) {
+				leafNode *leaf = static_cast<leafNode *>(p);
+				for (int i = 0; i < leaf->cnt; i++) {
+					leaf->key(i).~Key();
+					destroyEntry(leaf->vals[i]);
+				}
+				delete leaf;
+			}
+			else {
+				innerNode *q = static_cast<innerNode *>(p);
+				for (int i = 0; i < q->cnt; i++) destroyNode(q->child[i]);
+				for (int i = 0; i < q->cnt - 1; i++) q->key(i).~Key();
+				delete q;
+			}
+		}
+		//an empty map takes a copy of other's elements, or stays empty if a copy throws
+		void copyFrom(const btree_map &other) {
+			if (other.root == NULL) return;
+			try { root = copyNode(other.root, NULL); }
+			catch (...) {
+				root = NULL;
+				first = last = NULL;
+				throw;
+			}
+			siz = other.siz;
+		}
+		//copy in key order so that the leaves can be chained as they are made.
+		//a node that fails halfway frees what it holds, its parent frees the rest
+		nodeBase *copyNode(nodeBase *p, innerNode *parent) {
+			if (p->isLeaf) {
+				leafNode *from = static_cast<leafNode *>(p), *to = new leafNode;
+				to->parent = parent;
+				try {
+					for (int i = 0; i < from->cnt; i++) {
+						entry *e = newEntry(from->vals[i]->data());
+						try { new (to->keys + i) Key(from->key(i)); }
+						catch (...) { destroyEntry(e); throw; }
+						setVal(to, i, e);
+						to->cnt++;
+					}
+				}
+				catch (...) { destroyNode(to); throw; }
+				to->prev = last;
+				if (last != NULL) last->next = to;
+				else first = to;
+				last = to;
+				return to;
+			}
+			innerNode *from = static_cast<innerNode *>(p), *to = new innerNode;
+			to->parent = parent;
+			nodeBase *c = NULL;
+			try {
+				for (int i = 0; i < from->cnt; i++) {
+					c = copyNode(from->child[i], to);
+					if (i > 0) new (to->keys + i - 1) Key(from->key(i - 1));
+					to->child[i] = c;
+					c = NULL;
+					to->cnt++;
+				}
+			}
+			catch (...) {
+				if (c != NULL) destroyNode(c);
+				destroyNode(to);
+				throw;
+			}
+			return to;
+		}
+	};
+
+}
+#endif
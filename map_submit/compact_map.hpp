@@ -0,0 +1,664 @@
+/**
+* a red-black tree with the interface of sjtu::map whose nodes live in one
+* growable array and link to each other through 32-bit indices.
+* a node is the element plus 16 bytes: left, right, parent with the colour
+* in its top bit, and the subtree size that nth() and rank() need. there is
+* no thread, ++ and -- walk the tree in amortized O(1).
+* iterators are indices and stay valid until their element is erased, but
+* references to elements are invalidated whenever the array grows; reserve()
+* grows it ahead of time. at most 2^31 - 1 elements
+*/
+#ifndef SJTU_COMPACT_MAP_HPP
+#define SJTU_COMPACT_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "frozen_map.hpp"
+
+namespace sjtu {
+
+	template< class Key, class T, class Compare = std::less<Key>>
+	class compact_map {
+	public:
+		typedef pair<const Key, T> value_type;
+	private:
+		static const uint32_t redBit = 0x80000000u;
+		static const uint32_t indexMask = 0x7fffffffu;
+		static const uint32_t minCapacity = 16;
+
+		//slot 0 is never used, index 0 plays the role of NULL
+		struct node {
+			typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage;
+			uint32_t left;
+			uint32_t right;
+			uint32_t up; //parent index, the top bit set for a red node
+			uint32_t size; //nodes in this subtree, 0 for free slots
+			value_type & data() { return *reinterpret_cast<value_type *>(&storage); }
+		};
+
+		node *nodes;
+		uint32_t cap; //slots, counting slot 0
+		uint32_t used; //slots [1, used) have been handed out at least once
+		uint32_t freeList; //free slots, chained through left
+		uint32_t root;
+		Compare compare;
+		size_t siz;
+
+	public:
+		class const_iterator;
+		class iterator {
+		public:
+			uint32_t it; //0 at end()
+			compact_map<Key, T, Compare> *mPtr;
+			iterator() { it = 0; mPtr = NULL; }
+			iterator(compact_map<Key, T, Compare> &m, uint32_t p = 0) { mPtr = &m; it = p; }
+			iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
+			iterator & operator=(const iterator &other) {
+				it = other.it;
+				mPtr = other.mPtr;
+				return *this;
+			}
+			iterator operator++(int) {
+				iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			iterator & operator++() {
+				if (it == 0) throw invalid_iterator();
+				it = mPtr->nextNode(it);
+				return *this;
+			}
+			iterator operator--(int) {
+				iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			iterator & operator--() {
+				uint32_t p = mPtr->prevNode(it);
+				if (p == 0) throw invalid_iterator();
+				it = p;
+				return *this;
+			}
+			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			value_type & operator*() const {
+				if (it == 0) throw invalid_iterator();
+				else return mPtr->nodes[it].data();
+			}
+			value_type* operator->() const noexcept { return &(mPtr->nodes[it].data()); }
+		};
+		class const_iterator {
+		public:
+			uint32_t it;
+			const compact_map<Key, T, Compare> *mPtr;
+			const_iterator() { it = 0; mPtr = NULL; }
+			const_iterator(const compact_map<Key, T, Compare> &m, uint32_t p = 0) { mPtr = &m; it = p; }
+			const_iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
+			const_iterator(const const_iterator &other) { it = other.it; mPtr = other.mPtr; }
+			const_iterator & operator=(const const_iterator &other) {
+				it = other.it;
+				mPtr = other.mPtr;
+				return *this;
+			}
+			const_iterator operator++(int) {
+				const_iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (it == 0) throw invalid_iterator();
+				it = mPtr->nextNode(it);
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				uint32_t p = mPtr->prevNode(it);
+				if (p == 0) throw invalid_iterator();
+				it = p;
+				return *this;
+			}
+			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			const value_type & operator*() const {
+				if (it == 0) throw invalid_iterator();
+				else return mPtr->nodes[it].data();
+			}
+			const value_type* operator->() const noexcept { return &(mPtr->nodes[it].data()); }
+		};
+		compact_map() { init(); }
+		template<class InputIterator>
+		compact_map(InputIterator first, InputIterator last) {
+			init();
+			try { assign(first, last); }
+			catch (...) { release(); throw; }
+		}
+		//the array is copied slot by slot, links and free slots included
+		compact_map(const compact_map &other) {
+			init();
+			try { copyFrom(other); }
+			catch (...) { release(); throw; }
+		}
+		compact_map & operator=(const compact_map &other) {
+			if (this == &other) return *this;
+			release();
+			init();
+			copyFrom(other);
+			return *this;
+		}
+		~compact_map() { release(); }
+		T & at(const Key &key) {
+			uint32_t t = findNode(key);
+			if (t != 0) return nodes[t].data().second;
+			else throw index_out_of_bound();
+		}
+		const T & at(const Key &key) const {
+			uint32_t t = findNode(key);
+			if (t != 0) return nodes[t].data().second;
+			else throw index_out_of_bound();
+		}
+		T & operator[](const Key &key) {
+			uint32_t t = tryEmplace(key).first.it;
+			return nodes[t].data().second;
+		}
+		T & operator[](Key &&key) {
+			uint32_t t = tryEmplace(std::move(key)).first.it;
+			return nodes[t].data().second;
+		}
+		const T & operator[](const Key &key) const {
+			uint32_t t = findNode(key);
+			if (t != 0) return nodes[t].data().second;
+			else throw index_out_of_bound();
+		}
+		iterator begin() { return iterator(*this, firstNode()); }
+		const_iterator cbegin() const { return const_iterator(*this, firstNode()); }
+		iterator end() { return iterator(*this); }
+		const_iterator cend() const { return const_iterator(*this); }
+		bool empty() const { return siz == 0; }
+		size_t size() const { return siz; }
+		//room for n elements, so inserting up to n does not move the array
+		void reserve(size_t n) {
+			if (n + 1 > cap) grow(n + 1);
+		}
+		void clear() {
+			destroyAll();
+			used = 1;
+			freeList = 0;
+			root = 0;
+			siz = 0;
+		}
+		template<class InputIterator>
+		void assign(InputIterator first, InputIterator last) {
+			clear();
+			for (; first != last; ++first) tryEmplace((*first).first, (*first).second);
+		}
+		pair<iterator, bool> insert(const value_type &x) { return tryEmplace(x.first, x.second); }
+		pair<iterator, bool> insert(value_type &&x) { return tryEmplace(x.first, std::move(x.second)); }
+		//the value is built before the key is known, and destroyed again if the key is present
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			uint32_t t = newNode(std::forward<Args>(args)...);
+			uint32_t parent;
+			bool toLeft;
+			uint32_t old = findPosition(nodes[t].data().first, parent, toLeft);
+			if (old != 0) {
+				deleteNode(t);
+				return pair<iterator, bool>(iterator(*this, old), false);
+			}
+			linkNode(t, parent, toLeft);
+			return pair<iterator, bool>(iterator(*this, t), true);
+		}
+		//args are only used when key is missing; then the mapped value is built from them in place
+		template<class... Args>
+		pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+			return tryEmplace(key, std::forward<Args>(args)...);
+		}
+		template<class... Args>
+		pair<iterator, bool> try_emplace(Key &&key, Args&&... args) {
+			return tryEmplace(std::move(key), std::forward<Args>(args)...);
+		}
+		//there is no thread to splice into, so the hint is only checked and a full descent is made
+		iterator insert(iterator hint, const value_type &x) {
+			if (hint.mPtr != this) throw invalid_iterator();
+			return insert(x).first;
+		}
+		template<class... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			if (hint.mPtr != this) throw invalid_iterator();
+			return emplace(std::forward<Args>(args)...).first;
+		}
+		void erase(iterator pos) {
+			if (this->empty()) throw invalid_iterator();
+			if (pos.mPtr != this) throw invalid_iterator();
+			if (pos.it == 0) throw index_out_of_bound();
+			eraseNode(pos.it);
+		}
+		void erase(iterator first, iterator last) {
+			if (first.mPtr != this || last.mPtr != this) throw invalid_iterator();
+			while (first.it != last.it) {
+				if (first.it == 0) throw invalid_iterator();
+				uint32_t t = first.it;
+				first.it = nextNode(t);
+				eraseNode(t);
+			}
+		}
+		size_t erase(const Key &key) {
+			uint32_t t = findNode(key);
+			if (t == 0) return 0;
+			eraseNode(t);
+			return 1;
+		}
+		size_t count(const Key &key) const { return findNode(key) == 0 ? 0 : 1; }
+		//an immutable copy laid out for fast lookups, see frozen_map.hpp
+		frozen_map<Key, T, Compare> freeze() const {
+			return frozen_map<Key, T, Compare>(cbegin(), siz);
+		}
+		//the k-th smallest element, counting from 0
+		iterator nth(size_t k) {
+			if (k >= siz) throw index_out_of_bound();
+			return iterator(*this, select(k));
+		}
+		const_iterator nth(size_t k) const {
+			if (k >= siz) throw index_out_of_bound();
+			return const_iterator(*this, select(k));
+		}
+		//the number of keys less than key
+		size_t rank(const Key &key) const {
+			size_t k = 0;
+			for (uint32_t t = root; t != 0;) {
+				if (compare(nodes[t].data().first, key)) { k += nodes[nodes[t].left].size + 1; t = nodes[t].right; }
+				else t = nodes[t].left;
+			}
+			return k;
+		}
+		iterator find(const Key &key) { return iterator(*this, findNode(key)); }
+		const_iterator find(const Key &key) const { return const_iterator(*this, findNode(key)); }
+		iterator lower_bound(const Key &key) { return iterator(*this, lowerNode(key)); }
+		const_iterator lower_bound(const Key &key) const { return const_iterator(*this, lowerNode(key)); }
+		iterator upper_bound(const Key &key) { return iterator(*this, upperNode(key)); }
+		const_iterator upper_bound(const Key &key) const { return const_iterator(*this, upperNode(key)); }
+		pair<iterator, iterator> equal_range(const Key &key) {
+			uint32_t t = lowerNode(key);
+			if (t != 0 && !compare(key, nodes[t].data().first)) return pair<iterator, iterator>(iterator(*this, t), iterator(*this, nextNode(t)));
+			return pair<iterator, iterator>(iterator(*this, t), iterator(*this, t));
+		}
+		pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+			uint32_t t = lowerNode(key);
+			if (t != 0 && !compare(key, nodes[t].data().first)) return pair<const_iterator, const_iterator>(const_iterator(*this, t), const_iterator(*this, nextNode(t)));
+			return pair<const_iterator, const_iterator>(const_iterator(*this, t), const_iterator(*this, t));
+		}
+
+	private:
+		uint32_t parentOf(uint32_t t) const { return nodes[t].up & indexMask; }
+		void setParent(uint32_t t, uint32_t p) { nodes[t].up = (nodes[t].up & redBit) | p; }
+		bool isRed(uint32_t t) const { return t != 0 && (nodes[t].up & redBit) != 0; }
+		void setRed(uint32_t t, bool red) { nodes[t].up = (red ? nodes[t].up | redBit : nodes[t].up & indexMask); }
+
+		uint32_t lowerNode(const Key &key) const {
+			uint32_t ans = 0;
+			for (uint32_t t = root; t != 0;) {
+				if (compare(nodes[t].data().first, key)) t = nodes[t].right;
+				else { ans = t; t = nodes[t].left; }
+			}
+			return ans;
+		}
+		uint32_t upperNode(const Key &key) const {
+			uint32_t ans = 0;
+			for (uint32_t t = root; t != 0;) {
+				if (compare(key, nodes[t].data().first)) { ans = t; t = nodes[t].left; }
+				else t = nodes[t].right;
+			}
+			return ans;
+		}
+		uint32_t findNode(const Key &key) const {
+			uint32_t t = lowerNode(key);
+			return (t != 0 && !compare(key, nodes[t].data().first)) ? t : 0;
+		}
+		//the node holding key, or 0 and the parent a new node for key goes under
+		uint32_t findPosition(const Key &key, uint32_t &parent, bool &toLeft) const {
+			parent = 0;
+			toLeft = false;
+			for (uint32_t t = root; t != 0;) {
+				parent = t;
+				if (compare(key, nodes[t].data().first)) { toLeft = true; t = nodes[t].left; }
+				else if (compare(nodes[t].data().first, key)) { toLeft = false; t = nodes[t].right; }
+				else return t;
+			}
+			return 0;
+		}
+		uint32_t select(size_t k) const {
+			uint32_t t = root;
+			for (;;) {
+				size_t l = nodes[nodes[t].left].size;
+				if (k < l) t = nodes[t].left;
+				else if (k == l) return t;
+				else { k -= l + 1; t = nodes[t].right; }
+			}
+		}
+		uint32_t firstNode() const {
+			uint32_t t = root;
+			if (t != 0) while (nodes[t].left != 0) t = nodes[t].left;
+			return t;
+		}
+		uint32_t lastNode() const {
+			uint32_t t = root;
+			if (t != 0) while (nodes[t].right != 0) t = nodes[t].right;
+			return t;
+		}
+		//in-order neighbours, 0 past the last element; the one before end() is the last element
+		uint32_t nextNode(uint32_t t) const {
+			if (nodes[t].right != 0) {
+				t = nodes[t].right;
+				while (nodes[t].left != 0) t = nodes[t].left;
+				return t;
+			}
+			uint32_t p = parentOf(t);
+			while (p != 0 && nodes[p].right == t) { t = p; p = parentOf(t); }
+			return p;
+		}
+		uint32_t prevNode(uint32_t t) const {
+			if (t == 0) return lastNode();
+			if (nodes[t].left != 0) {
+				t = nodes[t].left;
+				while (nodes[t].right != 0) t = nodes[t].right;
+				return t;
+			}
+			uint32_t p = parentOf(t);
+			while (p != 0 && nodes[p].left == t) { t = p; p = parentOf(t); }
+			return p;
+		}
+
+		template<class K, class... Args>
+		pair<iterator, bool> tryEmplace(K &&key, Args&&... args) {
+			uint32_t parent;
+			bool toLeft;
+			uint32_t t = findPosition(key, parent, toLeft);
+			if (t != 0) return pair<iterator, bool>(iterator(*this, t), false);
+			t = newNode(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+				std::forward_as_tuple(std::forward<Args>(args)...));
+			linkNode(t, parent, toLeft);
+			return pair<iterator, bool>(iterator(*this, t), true);
+		}
+		//link a new node under parent (0 for an empty tree) and rebalance
+		void linkNode(uint32_t t, uint32_t parent, bool toLeft) {
+			siz++;
+			nodes[t].left = nodes[t].right = 0;
+			nodes[t].up = parent | redBit;
+			nodes[t].size = 1;
+			for (uint32_t p = parent; p != 0; p = parentOf(p)) nodes[p].size++;
+			if (parent == 0) {
+				root = t;
+				setRed(t, false);
+				return;
+			}
+			if (toLeft) nodes[parent].left = t;
+			else nodes[parent].right = t;
+			if (isRed(parent)) insertReBalance(t);
+		}
+
+		//a free slot, taking a new one or growing the array when there is none.
+		//the value is built before the old elements move, so args may refer to them
+		template<class... Args>
+		uint32_t newNode(Args&&... args) {
+			uint32_t t;
+			if (freeList != 0) {
+				t = freeList;
+				new (&nodes[t].storage) value_type(std::forward<Args>(args)...);
+				freeList = nodes[t].left;
+			}
+			else if (used < cap) {
+				t = used;
+				new (&nodes[t].storage) value_type(std::forward<Args>(args)...);
+				used++;
+			}
+			else {
+				if (cap == indexMask) throw runtime_error();
+				uint32_t n = (cap > indexMask / 2 ? indexMask : cap * 2);
+				node *bigger = static_cast<node *>(::operator new(n * sizeof(node)));
+				t = used;
+				try { new (&bigger[t].storage) value_type(std::forward<Args>(args)...); }
+				catch (...) { ::operator delete(bigger); throw; }
+				moveTo(bigger, n);
+				used++;
+			}
+			nodes[t].size = 1;
+			return t;
+		}
+		void deleteNode(uint32_t t) {
+			nodes[t].data().~value_type();
+			nodes[t].size = 0;
+			nodes[t].left = freeList;
+			freeList = t;
+		}
+		//move the used slots into a fresh array of n slots
+		void moveTo(node *bigger, uint32_t n) {
+			for (uint32_t i = 0; i < used; i++) {
+				bigger[i].left = nodes[i].left;
+				bigger[i].right = nodes[i].right;
+				bigger[i].up = nodes[i].up;
+				bigger[i].size = nodes[i].size;
+				if (nodes[i].size != 0) {
+					new (&bigger[i].storage) value_type(std::move(nodes[i].data()));
+					nodes[i].data().~value_type();
+				}
+			}
+			::operator delete(nodes);
+			nodes = bigger;
+			cap = n;
+		}
+		void grow(size_t n) {
+			if (n > indexMask) throw runtime_error();
+			node *bigger = static_cast<node *>(::operator new(n * sizeof(node)));
+			moveTo(bigger, (uint32_t)n);
+		}
+		void init() {
+			nodes = static_cast<node *>(::operator new(minCapacity * sizeof(node)));
+			nodes[0].left = nodes[0].right = nodes[0].up = nodes[0].size = 0;
+			cap = minCapacity;
+			used = 1;
+			freeList = 0;
+			root = 0;
+			siz = 0;
+		}
+		void destroyAll() {
+			if (!std::is_trivially_destructible<value_type>::value) {
+				for (uint32_t i = 1; i < used; i++)
+					if (nodes[i].size != 0) nodes[i].data().~value_type();
+			}
+		}
+		void release() {
+			destroyAll();
+			::operator delete(nodes);
+			nodes = NULL;
+		}
+		void copyFrom(const compact_map &other) {
+			if (other.used > cap) grow(other.used);
+			for (; used < other.used; used++) {
+				node &a = nodes[used], &b = other.nodes[used];
+				a.left = b.left;
+				a.right = b.right;
+				a.up = b.up;
+				a.size = 0; //not live until its value is built
+				if (b.size != 0) {
+					new (&a.storage) value_type(b.data());
+					a.size = b.size;
+				}
+			}
+			freeList = other.freeList;
+			root = other.root;
+			siz = other.siz;
+		}
+
+		void reLink(uint32_t oldp, uint32_t newp) {//newp takes oldp's place under oldp's parent
+			uint32_t p = parentOf(oldp);
+			if (p == 0) root = newp;
+			else if (nodes[p].left == oldp) nodes[p].left = newp;
+			else nodes[p].right = newp;
+			if (newp != 0) setParent(newp, p);
+		}
+		void LL(uint32_t t) {
+			uint32_t t1 = nodes[t].left;
+			nodes[t].left = nodes[t1].right;
+			if (nodes[t1].right != 0) setParent(nodes[t1].right, t);
+			reLink(t, t1);
+			nodes[t1].right = t;
+			setParent(t, t1);
+			nodes[t1].size = nodes[t].size;
+			nodes[t].size = nodes[nodes[t].left].size + nodes[nodes[t].right].size + 1;
+		}
+		void RR(uint32_t t) {
+			uint32_t t1 = nodes[t].right;
+			nodes[t].right = nodes[t1].left;
+			if (nodes[t1].left != 0) setParent(nodes[t1].left, t);
+			reLink(t, t1);
+			nodes[t1].left = t;
+			setParent(t, t1);
+			nodes[t1].size = nodes[t].size;
+			nodes[t].size = nodes[nodes[t].left].size + nodes[nodes[t].right].size + 1;
+		}
+		void LR(uint32_t t) {
+			RR(nodes[t].left);
+			LL(t);
+		}
+		void RL(uint32_t t) {
+			LL(nodes[t].right);
+			RR(t);
+		}
+		void insertReBalance(uint32_t t) {
+			uint32_t parent = parentOf(t), grandParent, uncle;
+			while (isRed(parent)) {
+				grandParent = parentOf(parent); //a red parent is not the root
+				uncle = (nodes[grandParent].left == parent ? nodes[grandParent].right : nodes[grandParent].left);
+				if (!isRed(uncle)) {
+					if (nodes[grandParent].left == parent) {
+						if (t == nodes[parent].left) { setRed(parent, false); setRed(grandParent, true); LL(grandParent); }
+						else { setRed(grandParent, true); setRed(t, false); LR(grandParent); }
+					}
+					else {
+						if (t == nodes[parent].right) { setRed(parent, false); setRed(grandParent, true); RR(grandParent); }
+						else { setRed(grandParent, true); setRed(t, false); RL(grandParent); }
+					}
+					break;
+				}
+				setRed(grandParent, true);
+				setRed(parent, false);
+				setRed(uncle, false);
+				t = grandParent;
+				parent = parentOf(t);
+			}
+			setRed(root, false);
+		}
+		//unlink t from the tree, rebalance upward from where it was, and free its slot
+		void eraseNode(uint32_t t) {
+			uint32_t child, parent;
+			bool removedRed = isRed(t);
+			uint32_t old = 0;
+			if (nodes[t].left != 0 && nodes[t].right != 0) {
+				old = nodes[t].right;
+				while (nodes[old].left != 0) old = nodes[old].left;
+			}
+			for (uint32_t p = parentOf(old != 0 ? old : t); p != 0; p = parentOf(p)) nodes[p].size--;
+			if (old == 0) {//a leaf or a node with one child
+				child = (nodes[t].left != 0 ? nodes[t].left : nodes[t].right);
+				parent = parentOf(t);
+				reLink(t, child);
+			}
+			else {//the successor takes t's place
+				removedRed = isRed(old);
+				child = nodes[old].right;
+				if (parentOf(old) == t) parent = old;
+				else {
+					parent = parentOf(old);
+					reLink(old, child);
+					nodes[old].right = nodes[t].right;
+					setParent(nodes[old].right, old);
+				}
+				reLink(t, old);
+				nodes[old].left = nodes[t].left;
+				setParent(nodes[old].left, old);
+				setRed(old, isRed(t));
+				nodes[old].size = nodes[t].size;
+			}
+			siz--;
+			deleteNode(t);
+			if (!removedRed) removeReBalance(child, parent);
+		}
+		void removeReBalance(uint32_t t, uint32_t parent) {//t lost a black node, t may be 0
+			uint32_t sibling;
+			while (t != root && !isRed(t)) {
+				if (nodes[parent].left == t) {
+					sibling = nodes[parent].right;
+					if (isRed(sibling)) {
+						setRed(sibling, false);
+						setRed(parent, true);
+						RR(parent);
+						sibling = nodes[parent].right;
+					}
+					if (!isRed(nodes[sibling].left) && !isRed(nodes[sibling].right)) {
+						setRed(sibling, true);
+						t = parent;
+						parent = parentOf(t);
+					}
+					else {
+						if (!isRed(nodes[sibling].right)) {
+							setRed(nodes[sibling].left, false);
+							setRed(sibling, true);
+							LL(sibling);
+							sibling = nodes[parent].right;
+						}
+						setRed(sibling, isRed(parent));
+						setRed(parent, false);
+						setRed(nodes[sibling].right, false);
+						RR(parent);
+						t = root;
+					}
+				}
+				else {
+					sibling = nodes[parent].left;
+					if (isRed(sibling)) {
+						setRed(sibling, false);
+						setRed(parent, true);
+						LL(parent);
+						sibling = nodes[parent].left;
+					}
+					if (!isRed(nodes[sibling].left) && !isRed(nodes[sibling].right)) {
+						setRed(sibling, true);
+						t = parent;
+						parent = parentOf(t);
+					}
+					else {
+						if (!isRed(nodes[sibling].left)) {
+							setRed(nodes[sibling].right, false);
+							setRed(sibling, true);
+							RR(sibling);
+							sibling = nodes[parent].left;
+						}
+						setRed(sibling, isRed(parent));
+						setRed(parent, false);
+						setRed(nodes[sibling].left, false);
+						LL(parent);
+						t = root;
+					}
+				}
+			}
+			if (t != 0) setRed(t, false);
+		}
+	};
+
+}
+
+#endif
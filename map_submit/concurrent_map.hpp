@@ -0,0 +1,161 @@
+/**
+* a map shared between threads, with the lookup interface of sjtu::map
+* the elements live in a persistent_map version that is never changed once
+* published: a writer builds the next version, swaps it in and frees the old one
+* after every reader that could still see it is done.
+* readers take no lock and never wait; they only count themselves in on a
+* per-thread stripe of reader counters, as in sleepable RCU. writers are serialized
+*/
+#ifndef SJTU_CONCURRENT_MAP_HPP
+#define SJTU_CONCURRENT_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "persistent_map.hpp"
+
+namespace sjtu {
+
+	template< class Key, class T, class Compare = std::less<Key>>
+	class concurrent_map {
+	public:
+		typedef pair<const Key, T> value_type;
+		typedef persistent_map<Key, T, Compare> snapshot_type;
+	private:
+		//threads spread over this many counter pairs, one cache line each
+		static const int stripes = 64;
+		//replaced versions wait in a batch, so one grace period covers many writes
+		static const int maxRetired = 64;
+		struct alignas(64) stripe {
+			std::atomic<size_t> readers[2];
+			stripe() { readers[0] = readers[1] = 0; }
+		};
+
+		std::atomic<snapshot_type *> current;
+		//readers count themselves in under the parity of epoch
+		mutable std::atomic<size_t> epoch;
+		mutable stripe counts[stripes];
+		std::mutex writer;
+		snapshot_type *retired[maxRetired];
+		int nRetired;
+
+		static int myStripe() {
+			static std::atomic<int> next(0);
+			static thread_local int s = next++ % stripes;
+			return s;
+		}
+		//a read-side critical section; the version loaded inside stays alive until it ends
+		class readGuard {
+		public:
+			readGuard(const concurrent_map &m) :counter(NULL) {
+				stripe &s = m.counts[myStripe()];
+				for (;;) {//a writer flipping the epoch in between may already be past our counter
+					size_t e = m.epoch.load();
+					counter = &s.readers[e & 1];
+					counter->fetch_add(1);
+					if (m.epoch.load() == e) break;
+					counter->fetch_sub(1);
+				}
+			}
+			~readGuard() { counter->fetch_sub(1, std::memory_order_release); }
+		private:
+			std::atomic<size_t> *counter;
+		};
+
+	public:
+		concurrent_map() :current(new snapshot_type), epoch(0), nRetired(0) {}
+		concurrent_map(const concurrent_map &other) :current(new snapshot_type(other.snapshot())), epoch(0), nRetired(0) {}
+		concurrent_map & operator=(const concurrent_map &other) {
+			if (this == &other) return *this;
+			snapshot_type v = other.snapshot();
+			std::lock_guard<std::mutex> lock(writer);
+			publish(v);
+			return *this;
+		}
+		~concurrent_map() {
+			for (int i = 0; i < nRetired; i++) delete retired[i];
+			delete current.load();
+		}
+
+		//lookups return copies: the element may be gone once they return
+		T at(const Key &key) const {
+			readGuard g(*this);
+			return current.load()->at(key);
+		}
+		size_t count(const Key &key) const {
+			readGuard g(*this);
+			return current.load()->count(key);
+		}
+		//call f on the value of key without copying it, false if key is missing.
+		//f must not write to this map
+		template<class F>
+		bool visit(const Key &key, F f) const {
+			readGuard g(*this);
+			const snapshot_type *v = current.load();
+			typename snapshot_type::const_iterator it = v->find(key);
+			if (it == v->cend()) return false;
+			f(it->second);
+			return true;
+		}
+		bool empty() const {
+			readGuard g(*this);
+			return current.load()->empty();
+		}
+		size_t size() const {
+			readGuard g(*this);
+			return current.load()->size();
+		}
+		//the current version, to iterate over at leisure
+		snapshot_type snapshot() const {
+			readGuard g(*this);
+			return *current.load();
+		}
+
+		bool insert(const value_type &x) {
+			std::lock_guard<std::mutex> lock(writer);
+			snapshot_type next = current.load()->insert(x);
+			if (next.size() == current.load()->size()) return false;
+			publish(next);
+			return true;
+		}
+		void insert_or_assign(const Key &key, const T &obj) {
+			std::lock_guard<std::mutex> lock(writer);
+			publish(current.load()->insert_or_assign(key, obj));
+		}
+		size_t erase(const Key &key) {
+			std::lock_guard<std::mutex> lock(writer);
+			snapshot_type next = current.load()->erase(key);
+			if (next.size() == current.load()->size()) return 0;
+			publish(next);
+			return 1;
+		}
+		void clear() {
+			std::lock_guard<std::mutex> lock(writer);
+			publish(snapshot_type());
+		}
+
+	private:
+		//swap in v; the old version is freed once no reader can hold it. the writer lock is held
+		void publish(const snapshot_type &v) {
+			retired[nRetired++] = current.exchange(new snapshot_type(v));
+			if (nRetired < maxRetired) return;
+			synchronize();
+			while (nRetired > 0) delete retired[--nRetired];
+		}
+		//wait until every reader that started before now has finished.
+		//readers that start later count under the other parity, so the wait is short
+		void synchronize() {
+			size_t e = epoch.fetch_add(1);
+			for (int i = 0; i < stripes; i++) {
+				while (counts[i].readers[e & 1].load() != 0) std::this_thread::yield();
+			}
+		}
+	};
+
+}
+
+#endif
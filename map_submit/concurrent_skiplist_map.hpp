@@ -0,0 +1,392 @@
+/**
+* a lock-free ordered map for many writers: a skip list after Fraser and
+* Herlihy-Shavit. an element is erased by marking the low bit of its links,
+* top level first, and unlinked by whichever search passes it next.
+* unlinked nodes are freed by epoch-based reclamation, once no thread can
+* still be walking over them
+*/
+#ifndef SJTU_CONCURRENT_SKIPLIST_MAP_HPP
+#define SJTU_CONCURRENT_SKIPLIST_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+	//epochs shared by every lock-free map. a thread pins the epoch while it may hold
+	//pointers into a map; a node unlinked and retired in epoch e is freed once the
+	//epoch has moved on to e + 2, since every thread pinned then has let go since
+	class epochDomain {
+	private:
+		struct retiree {
+			void *p;
+			void (*destroy)(void *);
+			size_t epoch;
+		};
+		//one per thread, handed on to a new thread when its owner exits
+		struct record {
+			std::atomic<size_t> local; //2 * epoch + 1 while pinned, 0 otherwise
+			std::atomic<bool> inUse;
+			record *next;
+			int nest;
+			std::vector<retiree> limbo;
+			record() :local(0), inUse(true), next(NULL), nest(0) {}
+		};
+		struct holder {
+			record *r;
+			holder() :r(NULL) {}
+			~holder() { if (r != NULL) r->inUse.store(false, std::memory_order_release); }
+		};
+		static const size_t scanEvery = 64;
+		std::atomic<size_t> epoch;
+		std::atomic<record *> records;
+
+		epochDomain() :epoch(1), records(NULL) {}
+		~epochDomain() {
+			for (record *r = records.load(), *next; r != NULL; r = next) {
+				next = r->next;
+				for (size_t i = 0; i < r->limbo.size(); i++) r->limbo[i].destroy(r->limbo[i].p);
+				delete r;
+			}
+		}
+		record &mine() {
+			static thread_local holder h;
+			if (h.r == NULL) h.r = acquire();
+			return *h.r;
+		}
+		record *acquire() {
+			for (record *r = records.load(); r != NULL; r = r->next) {
+				bool free = false;
+				if (!r->inUse.load() && r->inUse.compare_exchange_strong(free, true)) return r;
+			}
+			record *r = new record;
+			r->next = records.load();
+			while (!records.compare_exchange_weak(r->next, r));
+			return r;
+		}
+		//move to the next epoch if every pinned thread has seen this one
+		void tryAdvance() {
+			size_t e = epoch.load();
+			for (record *r = records.load(); r != NULL; r = r->next) {
+				size_t l = r->local.load();
+				if ((l & 1) != 0 && l != 2 * e + 1) return;
+			}
+			epoch.compare_exchange_strong(e, e + 1);
+		}
+		void collect(record &r) {
+			size_t e = epoch.load(), kept = 0;
+			for (size_t i = 0; i < r.limbo.size(); i++) {
+				if (r.limbo[i].epoch + 2 <= e) r.limbo[i].destroy(r.limbo[i].p);
+				else r.limbo[kept++] = r.limbo[i];
+			}
+			r.limbo.resize(kept);
+		}
+
+	public:
+		static epochDomain &global() {
+			static epochDomain d;
+			return d;
+		}
+		void pin() {
+			record &r = mine();
+			if (r.nest++ > 0) return;
+			r.local.exchange(2 * epoch.load() + 1);//a full barrier before the map is read
+		}
+		void unpin() {
+			record &r = mine();
+			if (--r.nest == 0) r.local.store(0, std::memory_order_release);
+		}
+		//p is unlinked; destroy(p) runs once no pinned thread can reach it
+		void retire(void *p, void (*destroy)(void *)) {
+			record &r = mine();
+			retiree x = { p, destroy, epoch.load() };
+			r.limbo.push_back(x);
+			if (r.limbo.size() % scanEvery == 0) {
+				tryAdvance();
+				collect(r);
+			}
+		}
+		//pins the epoch for as long as it lives, on the thread that made it
+		class guard {
+		public:
+			guard() { global().pin(); }
+			guard(const guard &) { global().pin(); }
+			guard & operator=(const guard &) { return *this; }
+			~guard() { global().unpin(); }
+		};
+	};
+
+	template< class Key, class T, class Compare = std::less<Key>>
+	class concurrent_skiplist_map {
+	public:
+		typedef pair<const Key, T> value_type;
+	private:
+		static const int maxLevel = 24;
+		struct node {
+			typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage;
+			std::atomic<int> owners; //the inserter while it links the node, and the map
+			int height;
+			std::atomic<uintptr_t> next[1]; //height links, a set low bit marks the node erased on that level
+
+			node(int h) :owners(2), height(h) {
+				next[0].store(0, std::memory_order_relaxed);
+				for (int i = 1; i < h; i++) new (&next[i]) std::atomic<uintptr_t>(0);
+			}
+			value_type & data() { return *reinterpret_cast<value_type *>(&storage); }
+		};
+
+		//the element count is spread over cache lines, so writers don't all hit one
+		static const int stripes = 64;
+		struct alignas(64) counter {
+			std::atomic<ptrdiff_t> n;
+			counter() :n(0) {}
+		};
+
+		node *head;
+		Compare compare;
+		counter siz[stripes];
+
+	public:
+		//walks level 0, skipping erased nodes; the nodes it passes stay allocated while it lives.
+		//an iterator may only be used on the thread that made it
+		class const_iterator {
+		public:
+			node *it;
+			const concurrent_skiplist_map<Key, T, Compare> *mPtr;
+			const_iterator() { it = NULL; mPtr = NULL; }
+			const_iterator(const concurrent_skiplist_map<Key, T, Compare> &m, node *p = NULL) { mPtr = &m; it = p; }
+			const_iterator operator++(int) {
+				const_iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (it == NULL) throw invalid_iterator();
+				it = live(ptr(it->next[0].load(std::memory_order_acquire)));
+				return *this;
+			}
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			const value_type & operator*() const {
+				if (it == NULL) throw invalid_iterator();
+				else return it->data();
+			}
+			const value_type* operator->() const noexcept { return &(it->data()); }
+		private:
+			epochDomain::guard g;
+		};
+		typedef const_iterator iterator;
+
+		concurrent_skiplist_map() { head = newNode(maxLevel); }
+		concurrent_skiplist_map(const concurrent_skiplist_map &other) {
+			head = newNode(maxLevel);
+			copy(other);
+		}
+		concurrent_skiplist_map & operator=(const concurrent_skiplist_map &other) {
+			if (this == &other) return *this;
+			clear();
+			copy(other);
+			return *this;
+		}
+		//no other thread may use the map any more
+		~concurrent_skiplist_map() {
+			node *p = ptr(head->next[0].load()), *next;
+			for (; p != NULL; p = next) {
+				next = ptr(p->next[0].load());
+				p->data().~value_type();
+				freeNode(p);
+			}
+			freeNode(head);
+		}
+
+		const_iterator find(const Key &key) const {
+			epochDomain::guard g;
+			node *p = lowerNode(key);
+			if (p == NULL || compare(key, p->data().first)) return cend();
+			return const_iterator(*this, p);
+		}
+		const_iterator lower_bound(const Key &key) const {
+			epochDomain::guard g;
+			return const_iterator(*this, lowerNode(key));
+		}
+		size_t count(const Key &key) const {
+			epochDomain::guard g;
+			node *p = lowerNode(key);
+			return p != NULL && !compare(key, p->data().first) ? 1 : 0;
+		}
+		const_iterator cbegin() const {
+			epochDomain::guard g;
+			return const_iterator(*this, live(ptr(head->next[0].load())));
+		}
+		const_iterator cend() const { return const_iterator(*this); }
+		const_iterator begin() const { return cbegin(); }
+		const_iterator end() const { return cend(); }
+		//exact while no thread is changing the map
+		bool empty() const { return size() == 0; }
+		size_t size() const {
+			ptrdiff_t n = 0;
+			for (int i = 0; i < stripes; i++) n += siz[i].n.load(std::memory_order_relaxed);
+			return n < 0 ? 0 : (size_t)n;
+		}
+
+		pair<const_iterator, bool> insert(const value_type &x) {
+			epochDomain::guard g;
+			node *preds[maxLevel], *succs[maxLevel];
+			int h = randomHeight();
+			node *p = NULL;
+			for (;;) {
+				if (findNode(x.first, preds, succs)) {
+					if (p != NULL) {//never published
+						p->data().~value_type();
+						freeNode(p);
+					}
+					return pair<const_iterator, bool>(const_iterator(*this, succs[0]), false);
+				}
+				if (p == NULL) {
+					p = newNode(h);
+					try { new (&p->storage) value_type(x); }
+					catch (...) { freeNode(p); throw; }
+				}
+				for (int i = 0; i < h; i++) p->next[i].store((uintptr_t)succs[i], std::memory_order_relaxed);
+				uintptr_t expected = (uintptr_t)succs[0];
+				if (preds[0]->next[0].compare_exchange_strong(expected, (uintptr_t)p)) break;
+			}
+			siz[myStripe()].n.fetch_add(1, std::memory_order_relaxed);
+			//the upper levels are only shortcuts; stop as soon as the node is erased
+			for (int i = 1; i < h && linkLevel(p, i, preds, succs); i++);
+			if (marked(p->next[0].load())) findNode(x.first, preds, succs);//unlink what was linked after the eraser looked
+			release(p);
+			return pair<const_iterator, bool>(const_iterator(*this, p), true);
+		}
+		size_t erase(const Key &key) {
+			epochDomain::guard g;
+			node *preds[maxLevel], *succs[maxLevel];
+			if (!findNode(key, preds, succs)) return 0;
+			node *p = succs[0];
+			for (int i = p->height - 1; i > 0; i--) {
+				uintptr_t succ = p->next[i].load();
+				while (!marked(succ)) p->next[i].compare_exchange_weak(succ, succ | 1);
+			}
+			uintptr_t succ = p->next[0].load();
+			do {
+				if (marked(succ)) return 0;//another thread erased it first
+			} while (!p->next[0].compare_exchange_weak(succ, succ | 1));
+			siz[myStripe()].n.fetch_sub(1, std::memory_order_relaxed);
+			findNode(key, preds, succs);
+			release(p);
+			return 1;
+		}
+		//erases the elements one by one, so other threads may keep working
+		void clear() {
+			for (const_iterator it = cbegin(); it != cend(); ++it) erase(it->first);
+		}
+
+	private:
+		static node *ptr(uintptr_t p) { return reinterpret_cast<node *>(p & ~(uintptr_t)1); }
+		static bool marked(uintptr_t p) { return (p & 1) != 0; }
+		//p, or the first node after it that is not erased
+		static node *live(node *p) {
+			while (p != NULL && marked(p->next[0].load(std::memory_order_acquire))) p = ptr(p->next[0].load(std::memory_order_acquire));
+			return p;
+		}
+		static node *newNode(int h) {
+			void *raw = ::operator new(sizeof(node) + (h - 1) * sizeof(std::atomic<uintptr_t>));
+			return new (raw) node(h);
+		}
+		static void freeNode(node *p) { ::operator delete(p); }
+		static void destroyNode(void *q) {
+			node *p = static_cast<node *>(q);
+			p->data().~value_type();
+			freeNode(p);
+		}
+		//the inserter and the map each let go once; the last one retires the node
+		static void release(node *p) {
+			if (p->owners.fetch_sub(1) == 1) epochDomain::global().retire(p, destroyNode);
+		}
+		static int myStripe() {
+			static std::atomic<int> next(0);
+			static thread_local int s = next++ % stripes;
+			return s;
+		}
+		//heights are geometric with p = 1/2
+		static int randomHeight() {
+			static std::atomic<unsigned> seeds(2017);
+			static thread_local unsigned state = seeds.fetch_add(0x9e3779b9u) | 1;
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			int h = 1;
+			for (unsigned r = state; h < maxLevel && (r & 1) != 0; r >>= 1) h++;
+			return h;
+		}
+		//the nodes around key on every level, unlinking erased nodes on the way; true if key is present
+		bool findNode(const Key &key, node **preds, node **succs) const {
+			while (!search(key, preds, succs));
+			return succs[0] != NULL && !compare(key, succs[0]->data().first);
+		}
+		//false if a link changed under us, then the search starts over
+		bool search(const Key &key, node **preds, node **succs) const {
+			node *pred = head;
+			for (int level = maxLevel - 1; level >= 0; level--) {
+				node *curr = ptr(pred->next[level].load());
+				while (curr != NULL) {
+					uintptr_t succ = curr->next[level].load();
+					if (marked(succ)) {
+						uintptr_t expected = (uintptr_t)curr;
+						if (!pred->next[level].compare_exchange_strong(expected, succ & ~(uintptr_t)1)) return false;
+						curr = ptr(succ);
+						continue;
+					}
+					if (!compare(curr->data().first, key)) break;
+					pred = curr;
+					curr = ptr(succ);
+				}
+				preds[level] = pred;
+				succs[level] = curr;
+			}
+			return true;
+		}
+		//the first node not erased and not less than key, read only
+		node *lowerNode(const Key &key) const {
+			node *pred = head, *curr = NULL;
+			for (int level = maxLevel - 1; level >= 0; level--) {
+				curr = ptr(pred->next[level].load(std::memory_order_acquire));
+				while (curr != NULL) {
+					uintptr_t succ = curr->next[level].load(std::memory_order_acquire);
+					if (marked(succ)) curr = ptr(succ);
+					else if (compare(curr->data().first, key)) {
+						pred = curr;
+						curr = ptr(succ);
+					}
+					else break;
+				}
+			}
+			return curr;
+		}
+		//link p on level i, false if p was erased meanwhile
+		bool linkLevel(node *p, int i, node **preds, node **succs) {
+			for (;;) {
+				uintptr_t old = p->next[i].load();
+				if (marked(old)) return false;
+				if (ptr(old) != succs[i] && !p->next[i].compare_exchange_strong(old, (uintptr_t)succs[i])) return false;
+				uintptr_t expected = (uintptr_t)succs[i];
+				if (preds[i]->next[i].compare_exchange_strong(expected, (uintptr_t)p)) return true;
+				findNode(p->data().first, preds, succs);
+				if (succs[0] != p) return false;
+			}
+		}
+		void copy(const concurrent_skiplist_map &other) {
+			for (const_iterator it = other.cbegin(); it != other.cend(); ++it) insert(*it);
+		}
+	};
+
+}
+
+#endif
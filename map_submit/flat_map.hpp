@@ -0,0 +1,394 @@
+/**
+* a sorted array with the interface of sjtu::map, for maps of up to a few
+* thousand elements: keys and values sit in two contiguous arrays, so a map
+* costs sizeof(Key) + sizeof(T) per element and a lookup is a binary search
+* over the keys alone. inserting and erasing move the elements after the
+* position, and invalidate iterators like they do for a vector.
+* Key and T should not throw when moved
+*/
+#ifndef SJTU_FLAT_MAP_HPP
+#define SJTU_FLAT_MAP_HPP
+
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+	template< class Key, class T, class Compare = std::less<Key>>
+	class flat_map {
+	public:
+		typedef pair<const Key, T> value_type;
+		//what iterators point to: the key and value, which live in different arrays
+		typedef pair<const Key &, T &> reference;
+		typedef pair<const Key &, const T &> const_reference;
+	private:
+		Key *keys;
+		T *vals;
+		size_t siz;
+		size_t cap;
+		Compare compare;
+
+	public:
+		//it-> needs something to point to
+		template<class Ref>
+		class arrow {
+		public:
+			arrow(const Ref &r) :r(r) {}
+			const Ref * operator->() const { return &r; }
+		private:
+			Ref r;
+		};
+		class const_iterator;
+		class iterator {
+		public:
+			size_t it; //index, size() at end()
+			flat_map<Key, T, Compare> *mPtr;
+			iterator() { it = 0; mPtr = NULL; }
+			iterator(flat_map<Key, T, Compare> &m, size_t i) { mPtr = &m; it = i; }
+			iterator operator++(int) {
+				iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			iterator & operator++() {
+				if (it >= mPtr->siz) throw invalid_iterator();
+				it++;
+				return *this;
+			}
+			iterator operator--(int) {
+				iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			iterator & operator--() {
+				if (it == 0) throw invalid_iterator();
+				it--;
+				return *this;
+			}
+			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			reference operator*() const {
+				if (it >= mPtr->siz) throw invalid_iterator();
+				return reference(mPtr->keys[it], mPtr->vals[it]);
+			}
+			arrow<reference> operator->() const { return arrow<reference>(reference(mPtr->keys[it], mPtr->vals[it])); }
+		};
+		class const_iterator {
+		public:
+			size_t it;
+			const flat_map<Key, T, Compare> *mPtr;
+			const_iterator() { it = 0; mPtr = NULL; }
+			const_iterator(const flat_map<Key, T, Compare> &m, size_t i) { mPtr = &m; it = i; }
+			const_iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
+			const_iterator operator++(int) {
+				const_iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (it >= mPtr->siz) throw invalid_iterator();
+				it++;
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				if (it == 0) throw invalid_iterator();
+				it--;
+				return *this;
+			}
+			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			const_reference operator*() const {
+				if (it >= mPtr->siz) throw invalid_iterator();
+				return const_reference(mPtr->keys[it], mPtr->vals[it]);
+			}
+			arrow<const_reference> operator->() const { return arrow<const_reference>(const_reference(mPtr->keys[it], mPtr->vals[it])); }
+		};
+		flat_map() :keys(NULL), vals(NULL), siz(0), cap(0) {}
+		template<class InputIterator>
+		flat_map(InputIterator first, InputIterator last) :keys(NULL), vals(NULL), siz(0), cap(0) {
+			try { insert(first, last); }
+			catch (...) { release(); throw; }
+		}
+		flat_map(const flat_map &other) :keys(NULL), vals(NULL), siz(0), cap(0) {
+			try { copyFrom(other); }
+			catch (...) { release(); throw; }
+		}
+		flat_map & operator=(const flat_map &other) {
+			if (this == &other) return *this;
+			clear();
+			copyFrom(other);
+			return *this;
+		}
+		~flat_map() { release(); }
+		T & at(const Key &key) {
+			size_t i = findIndex(key);
+			if (i == siz) throw index_out_of_bound();
+			return vals[i];
+		}
+		const T & at(const Key &key) const {
+			size_t i = findIndex(key);
+			if (i == siz) throw index_out_of_bound();
+			return vals[i];
+		}
+		T & operator[](const Key &key) {
+			size_t i = tryEmplace(key).first.it;
+			return vals[i];
+		}
+		T & operator[](Key &&key) {
+			size_t i = tryEmplace(std::move(key)).first.it;
+			return vals[i];
+		}
+		const T & operator[](const Key &key) const { return at(key); }
+		iterator begin() { return iterator(*this, 0); }
+		const_iterator cbegin() const { return const_iterator(*this, 0); }
+		iterator end() { return iterator(*this, siz); }
+		const_iterator cend() const { return const_iterator(*this, siz); }
+		bool empty() const { return siz == 0; }
+		size_t size() const { return siz; }
+		size_t capacity() const { return cap; }
+		//room for n elements, so inserting up to n moves no element to a new array
+		void reserve(size_t n) {
+			if (n > cap) grow(n);
+		}
+		void clear() {
+			destroy(0, siz);
+			siz = 0;
+		}
+		pair<iterator, bool> insert(const value_type &x) { return tryEmplace(x.first, x.second); }
+		pair<iterator, bool> insert(value_type &&x) { return tryEmplace(x.first, std::move(x.second)); }
+		//bulk insertion: the new elements are appended, sorted, and merged with the old ones
+		//in one pass, so n new elements cost O(n log n + size()), and appending keys that
+		//are already sorted and greater than the old ones costs O(n). the first of equal keys is kept
+		template<class InputIterator>
+		void insert(InputIterator first, InputIterator last) {
+			size_t old = siz;
+			try {
+				for (; first != last; ++first) {
+					if (siz == cap) grow(cap == 0 ? 8 : 2 * cap);
+					new (keys + siz) Key((*first).first);
+					try { new (vals + siz) T((*first).second); }
+					catch (...) { keys[siz].~Key(); throw; }
+					siz++;
+				}
+			}
+			catch (...) {
+				destroy(old, siz);
+				siz = old;
+				throw;
+			}
+			bool sorted = (old == 0 || siz == old || compare(keys[old - 1], keys[old]));
+			for (size_t i = old + 1; i < siz && sorted; i++) sorted = compare(keys[i - 1], keys[i]);
+			if (!sorted) mergeTail(old);
+		}
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			value_type x(std::forward<Args>(args)...);
+			return tryEmplace(x.first, std::move(x.second));
+		}
+		//args must not refer to elements of this map, which may move before the value is built
+		template<class... Args>
+		pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+			return tryEmplace(key, std::forward<Args>(args)...);
+		}
+		template<class... Args>
+		pair<iterator, bool> try_emplace(Key &&key, Args&&... args) {
+			return tryEmplace(std::move(key), std::forward<Args>(args)...);
+		}
+		void erase(iterator pos) {
+			if (this->empty()) throw invalid_iterator();
+			if (pos.mPtr != this) throw invalid_iterator();
+			if (pos.it >= siz) throw index_out_of_bound();
+			eraseRange(pos.it, pos.it + 1);
+		}
+		void erase(iterator first, iterator last) {
+			if (first.mPtr != this || last.mPtr != this) throw invalid_iterator();
+			if (first.it > last.it || last.it > siz) throw invalid_iterator();
+			eraseRange(first.it, last.it);
+		}
+		size_t erase(const Key &key) {
+			size_t i = findIndex(key);
+			if (i == siz) return 0;
+			eraseRange(i, i + 1);
+			return 1;
+		}
+		size_t count(const Key &key) const { return findIndex(key) == siz ? 0 : 1; }
+		iterator find(const Key &key) { return iterator(*this, findIndex(key)); }
+		const_iterator find(const Key &key) const { return const_iterator(*this, findIndex(key)); }
+		iterator lower_bound(const Key &key) { return iterator(*this, lowerIndex(key)); }
+		const_iterator lower_bound(const Key &key) const { return const_iterator(*this, lowerIndex(key)); }
+		iterator upper_bound(const Key &key) { return iterator(*this, upperIndex(key)); }
+		const_iterator upper_bound(const Key &key) const { return const_iterator(*this, upperIndex(key)); }
+
+	private:
+		//the searches halve a window that always has the same length for a given size,
+		//so the loop has no branch on the comparison and compiles to conditional moves
+		size_t lowerIndex(const Key &key) const {
+			if (siz == 0) return 0;
+			const Key *base = keys;
+			for (size_t len = siz; len > 1; len -= len / 2)
+				base = (compare(base[len / 2 - 1], key) ? base + len / 2 : base);
+			return (base - keys) + (compare(*base, key) ? 1 : 0);
+		}
+		size_t upperIndex(const Key &key) const {
+			if (siz == 0) return 0;
+			const Key *base = keys;
+			for (size_t len = siz; len > 1; len -= len / 2)
+				base = (compare(key, base[len / 2 - 1]) ? base : base + len / 2);
+			return (base - keys) + (compare(key, *base) ? 0 : 1);
+		}
+		//siz if key is missing
+		size_t findIndex(const Key &key) const {
+			size_t i = lowerIndex(key);
+			return (i < siz && !compare(key, keys[i])) ? i : siz;
+		}
+		template<class K, class... Args>
+		pair<iterator, bool> tryEmplace(K &&key, Args&&... args) {
+			size_t i = lowerIndex(key);
+			if (i < siz && !compare(key, keys[i])) return pair<iterator, bool>(iterator(*this, i), false);
+			if (siz == cap) grow(cap == 0 ? 8 : 2 * cap);
+			shift(i, siz, 1);
+			try {
+				new (keys + i) Key(std::forward<K>(key));
+				try { new (vals + i) T(std::forward<Args>(args)...); }
+				catch (...) { keys[i].~Key(); throw; }
+			}
+			catch (...) {
+				shift(i + 1, siz + 1, -1);
+				throw;
+			}
+			siz++;
+			return pair<iterator, bool>(iterator(*this, i), true);
+		}
+		void eraseRange(size_t l, size_t r) {
+			destroy(l, r);
+			shift(r, siz, -(ptrdiff_t)(r - l));
+			siz -= r - l;
+		}
+
+		//elements are moved by move-and-destroy since Key need not be assignable
+		template<class X>
+		static void relocate(X *to, X *from) {
+			new (to) X(std::move(*from));
+			from->~X();
+		}
+		//move elements [l, r) by d slots, the destination slots must be empty
+		void shift(size_t l, size_t r, ptrdiff_t d) {
+			if (d > 0) {
+				for (size_t i = r; i > l; i--) {
+					relocate(keys + i - 1 + d, keys + i - 1);
+					relocate(vals + i - 1 + d, vals + i - 1);
+				}
+			}
+			else {
+				for (size_t i = l; i < r; i++) {
+					relocate(keys + i + d, keys + i);
+					relocate(vals + i + d, vals + i);
+				}
+			}
+		}
+		void destroy(size_t l, size_t r) {
+			if (!std::is_trivially_destructible<Key>::value)
+				for (size_t i = l; i < r; i++) keys[i].~Key();
+			if (!std::is_trivially_destructible<T>::value)
+				for (size_t i = l; i < r; i++) vals[i].~T();
+		}
+		void release() {
+			destroy(0, siz);
+			::operator delete(keys);
+			::operator delete(vals);
+			keys = NULL;
+			vals = NULL;
+			siz = cap = 0;
+		}
+		//new arrays of n slots, n >= siz
+		void grow(size_t n) {
+			Key *k = static_cast<Key *>(::operator new(n * sizeof(Key)));
+			T *v;
+			try { v = static_cast<T *>(::operator new(n * sizeof(T))); }
+			catch (...) { ::operator delete(k); throw; }
+			for (size_t i = 0; i < siz; i++) {
+				relocate(k + i, keys + i);
+				relocate(v + i, vals + i);
+			}
+			::operator delete(keys);
+			::operator delete(vals);
+			keys = k;
+			vals = v;
+			cap = n;
+		}
+		void copyFrom(const flat_map &other) {
+			if (other.siz > cap) grow(other.siz);
+			for (; siz < other.siz; siz++) {
+				new (keys + siz) Key(other.keys[siz]);
+				try { new (vals + siz) T(other.vals[siz]); }
+				catch (...) { keys[siz].~Key(); throw; }
+			}
+		}
+		//sort elements [old, siz) and merge them into [0, old), dropping keys already present
+		void mergeTail(size_t old) {
+			size_t n = siz - old;
+			size_t *order = static_cast<size_t *>(::operator new(n * sizeof(size_t)));
+			for (size_t i = 0; i < n; i++) order[i] = old + i;
+			const Key *k = keys;
+			const Compare &cmp = compare;
+			std::stable_sort(order, order + n, [k, &cmp](size_t a, size_t b) { return cmp(k[a], k[b]); });
+			Key *nk;
+			T *nv;
+			try {
+				nk = static_cast<Key *>(::operator new(cap * sizeof(Key)));
+				try { nv = static_cast<T *>(::operator new(cap * sizeof(T))); }
+				catch (...) { ::operator delete(nk); throw; }
+			}
+			catch (...) { ::operator delete(order); throw; }
+			size_t i = 0, j = 0, m = 0;
+			while (i < old || j < n) {
+				size_t from;
+				if (j == n || (i < old && !compare(keys[order[j]], keys[i]))) {
+					//an old key wins over an equal new one
+					if (j < n && !compare(keys[i], keys[order[j]])) {
+						keys[order[j]].~Key();
+						vals[order[j]].~T();
+						j++;
+						continue;
+					}
+					from = i++;
+				}
+				else {
+					from = order[j++];
+					if (m > 0 && !compare(nk[m - 1], keys[from])) {
+						keys[from].~Key();
+						vals[from].~T();
+						continue;
+					}
+				}
+				relocate(nk + m, keys + from);
+				relocate(nv + m, vals + from);
+				m++;
+			}
+			::operator delete(order);
+			::operator delete(keys);
+			::operator delete(vals);
+			keys = nk;
+			vals = nv;
+			siz = m;
+		}
+	};
+
+}
+
+#endif
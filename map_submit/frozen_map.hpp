@@ -0,0 +1,298 @@
+/**
+* an immutable sorted map for maps that are built once and then only read.
+* the keys sit in one array in Eytzinger order, the breadth-first order of a
+* complete binary search tree: the children of slot k are 2k and 2k + 1.
+* the top of the tree shares a few cache lines, a search is a branch-free
+* loop that prefetches the line of descendants log2(64 / sizeof(Key)) levels
+* down (four for 4-byte keys, none past 32 bytes), and values wait in a
+* parallel array until a key has been found.
+* save() writes the two arrays to a file that mapped_map serves in place
+*/
+#ifndef SJTU_FROZEN_MAP_HPP
+#define SJTU_FROZEN_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+	//a file written by frozen_map::save(): this header, then the keys from keysOffset and the
+	//values from valuesOffset, each in slot order with slot 0 zeroed. offsets are from the
+	//start of the file, so the image can be mapped at any address
+	struct mapImageHeader {
+		char magic[8];
+		uint32_t byteOrder; //0x01020304 as the writer stored it
+		uint32_t version;
+		uint64_t keySize;
+		uint64_t valueSize;
+		uint64_t n;
+		uint64_t keysOffset;
+		uint64_t valuesOffset;
+		uint64_t fileSize;
+	};
+
+	template<class Key, class T, class Compare> class mapped_map;
+
+	template< class Key, class T, class Compare = std::less<Key>>
+	class frozen_map {
+		template<class K, class V, class C> friend class mapped_map;
+	public:
+		typedef pair<const Key, T> value_type;
+		//what an iterator points to: the key and value, which live in different arrays
+		typedef pair<const Key &, const T &> reference;
+	private:
+		static const size_t lineSize = 64;
+		//slots per cache line; slot k * perLine starts the line of k's descendants log2(perLine) levels down
+		static const size_t perLine = (sizeof(Key) < lineSize ? lineSize / sizeof(Key) : 1);
+
+		Key *keys; //slots 1..n, slot 0 is unused
+		T *values;
+		void *rawKeys;
+		size_t n;
+		bool owned; //false for a view of a mapped image
+		Compare compare;
+
+	public:
+		static const uint32_t imageVersion = 1;
+		class const_iterator {
+		public:
+			size_t it; //slot, 0 at end()
+			const frozen_map<Key, T, Compare> *mPtr;
+			//it-> needs something to point to
+			class arrow {
+			public:
+				arrow(const reference &r) :r(r) {}
+				const reference * operator->() const { return &r; }
+			private:
+				reference r;
+			};
+			const_iterator() { it = 0; mPtr = NULL; }
+			const_iterator(const frozen_map<Key, T, Compare> &m, size_t k = 0) { mPtr = &m; it = k; }
+			const_iterator operator++(int) {
+				const_iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (it == 0) throw invalid_iterator();
+				it = mPtr->nextSlot(it);
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				size_t k = (it == 0 ? mPtr->lastSlot() : mPtr->prevSlot(it));
+				if (k == 0) throw invalid_iterator();
+				it = k;
+				return *this;
+			}
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			reference operator*() const {
+				if (it == 0) throw invalid_iterator();
+				return reference(mPtr->keys[it], mPtr->values[it]);
+			}
+			arrow operator->() const { return arrow(reference(mPtr->keys[it], mPtr->values[it])); }
+		};
+		typedef const_iterator iterator;
+
+		frozen_map() { init(0); }
+		//the first n elements from first, whose keys must be strictly ascending
+		template<class InputIterator>
+		frozen_map(InputIterator first, size_t n) {
+			init(n);
+			fill(first, n);
+		}
+		frozen_map(const frozen_map &other) {
+			init(other.n);
+			fill(other.cbegin(), other.n);
+		}
+		frozen_map & operator=(const frozen_map &other) {
+			if (this == &other) return *this;
+			frozen_map tmp(other);
+			std::swap(keys, tmp.keys);
+			std::swap(values, tmp.values);
+			std::swap(rawKeys, tmp.rawKeys);
+			std::swap(n, tmp.n);
+			std::swap(owned, tmp.owned);
+			return *this;
+		}
+		~frozen_map() {
+			if (!owned) return;
+			destroy(n);
+			::operator delete(rawKeys);
+			::operator delete(values);
+		}
+
+		const T & at(const Key &key) const {
+			size_t k = findSlot(key);
+			if (k == 0) throw index_out_of_bound();
+			return values[k];
+		}
+		const T & operator[](const Key &key) const { return at(key); }
+		size_t count(const Key &key) const { return findSlot(key) == 0 ? 0 : 1; }
+		const_iterator find(const Key &key) const { return const_iterator(*this, findSlot(key)); }
+		const_iterator lower_bound(const Key &key) const { return const_iterator(*this, lowerSlot(key)); }
+		const_iterator upper_bound(const Key &key) const { return const_iterator(*this, upperSlot(key)); }
+		const_iterator cbegin() const { return const_iterator(*this, firstSlot()); }
+		const_iterator cend() const { return const_iterator(*this); }
+		const_iterator begin() const { return cbegin(); }
+		const_iterator end() const { return cend(); }
+		bool empty() const { return n == 0; }
+		size_t size() const { return n; }
+		//write the map as an image for mapped_map, throws runtime_error if the file cannot be written
+		void save(const char *path) const {
+			static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value,
+				"keys and values are written as raw bytes, map::save takes a serializer for other types");
+			mapImageHeader h;
+			memset(&h, 0, sizeof(h));
+			memcpy(h.magic, "sjtumap", 8);
+			h.byteOrder = 0x01020304;
+			h.version = imageVersion;
+			h.keySize = sizeof(Key);
+			h.valueSize = sizeof(T);
+			h.n = n;
+			h.keysOffset = roundUp(sizeof(h), lineSize);
+			h.valuesOffset = roundUp(h.keysOffset + (n + 1) * sizeof(Key), alignof(T) > 8 ? alignof(T) : 8);
+			h.fileSize = h.valuesOffset + (n + 1) * sizeof(T);
+			FILE *f = fopen(path, "wb");
+			if (f == NULL) throw runtime_error();
+			size_t pos = 0;
+			bool ok = writeAt(f, pos, 0, &h, sizeof(h))
+				&& writeAt(f, pos, h.keysOffset + sizeof(Key), keys + 1, n * sizeof(Key))
+				&& writeAt(f, pos, h.valuesOffset + sizeof(T), values + 1, n * sizeof(T));
+			if (fclose(f) != 0) ok = false;
+			if (!ok) throw runtime_error();
+		}
+
+	private:
+		//a view of arrays it does not own
+		frozen_map(Key *keys, T *values, size_t n) :keys(keys), values(values), rawKeys(NULL), n(n), owned(false) {}
+		static size_t roundUp(size_t x, size_t a) { return (x + a - 1) / a * a; }
+		//zero-fill the file up to offset at, then write len bytes from p
+		static bool writeAt(FILE *f, size_t &pos, size_t at, const void *p, size_t len) {
+			static const char zeros[64] = {};
+			while (pos < at) {
+				size_t k = (at - pos < sizeof(zeros) ? at - pos : sizeof(zeros));
+				if (fwrite(zeros, 1, k, f) != k) return false;
+				pos += k;
+			}
+			if (len != 0 && fwrite(p, 1, len, f) != len) return false;
+			pos += len;
+			return true;
+		}
+		void init(size_t cnt) {
+			n = cnt;
+			owned = true;
+			//slot 0 starts a cache line, so the perLine descendants prefetched together share one
+			rawKeys = ::operator new((n + 1) * sizeof(Key) + lineSize);
+			uintptr_t p = reinterpret_cast<uintptr_t>(rawKeys);
+			keys = reinterpret_cast<Key *>((p + lineSize - 1) / lineSize * lineSize);
+			try { values = static_cast<T *>(::operator new((n + 1) * sizeof(T))); }
+			catch (...) { ::operator delete(rawKeys); throw; }
+		}
+		//copy the elements into the slots in order; what was built is undone if a copy throws
+		template<class InputIterator>
+		void fill(InputIterator first, size_t cnt) {
+			size_t done = 0, k = firstSlot();
+			try {
+				for (; done < cnt; ++done, ++first, k = nextSlot(k)) {
+					auto &&x = *first;
+					new (keys + k) Key(x.first);
+					try { new (values + k) T(x.second); }
+					catch (...) { keys[k].~Key(); throw; }
+				}
+			}
+			catch (...) {
+				destroy(done);
+				::operator delete(rawKeys);
+				::operator delete(values);
+				throw;
+			}
+		}
+		//destroy the first cnt elements in order
+		void destroy(size_t cnt) {
+			if (std::is_trivially_destructible<Key>::value && std::is_trivially_destructible<T>::value) return;
+			for (size_t k = firstSlot(); cnt > 0; cnt--, k = nextSlot(k)) {
+				keys[k].~Key();
+				values[k].~T();
+			}
+		}
+		static void prefetch(const void *p) {
+#if defined(__GNUC__)
+			__builtin_prefetch(p);
+#endif
+		}
+		//the walk down ends in an empty slot below the answer;
+		//the answer is where the walk last turned left, found by dropping the right turns after it
+		static size_t lastLeftTurn(size_t k) {
+			while ((k & 1) != 0) k >>= 1;
+			return k >> 1;
+		}
+		//the first slot whose key is not less than key, 0 if there is none
+		size_t lowerSlot(const Key &key) const {
+			size_t k = 1;
+			while (k <= n) {
+				prefetch(keys + k * perLine);
+				k = 2 * k + (compare(keys[k], key) ? 1 : 0);
+			}
+			return lastLeftTurn(k);
+		}
+		//the first slot whose key is greater than key, 0 if there is none
+		size_t upperSlot(const Key &key) const {
+			size_t k = 1;
+			while (k <= n) {
+				prefetch(keys + k * perLine);
+				k = 2 * k + (compare(key, keys[k]) ? 0 : 1);
+			}
+			return lastLeftTurn(k);
+		}
+		size_t findSlot(const Key &key) const {
+			size_t k = lowerSlot(key);
+			return (k != 0 && !compare(key, keys[k])) ? k : 0;
+		}
+		size_t firstSlot() const {
+			if (n == 0) return 0;
+			size_t k = 1;
+			while (2 * k <= n) k = 2 * k;
+			return k;
+		}
+		size_t lastSlot() const {
+			if (n == 0) return 0;
+			size_t k = 1;
+			while (2 * k + 1 <= n) k = 2 * k + 1;
+			return k;
+		}
+		//in-order neighbours of slot k, 0 past either end
+		size_t nextSlot(size_t k) const {
+			if (2 * k + 1 <= n) {
+				k = 2 * k + 1;
+				while (2 * k <= n) k = 2 * k;
+				return k;
+			}
+			return lastLeftTurn(k);
+		}
+		size_t prevSlot(size_t k) const {
+			if (2 * k <= n) {
+				k = 2 * k;
+				while (2 * k + 1 <= n) k = 2 * k + 1;
+				return k;
+			}
+			while (k > 1 && (k & 1) == 0) k >>= 1;
+			return k >> 1;
+		}
+	};
+
+}
+
+#endif
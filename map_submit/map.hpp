@@ -4,80 +4,180 @@
 #ifndef SJTU_MAP_HPP
 #define SJTU_MAP_HPP
 
-// only for std::less<T>
 #include <functional>
 #include <cstddef>
+#include <atomic>
+#include <new>
+#include <tuple>
+#include <type_traits>
 #include "utility.hpp"
 #include "exceptions.hpp"
+//freeze() and save() build a frozen_map, serialize() writes the format of serial.hpp
+#include "frozen_map.hpp"
+#include "serial.hpp"
+#include "memory_resource.hpp"
 
 namespace sjtu {
 
+	//map_union, map_intersection and map_difference, see map_algebra.hpp
+	template<class Map> struct setAlgebra;
+
 	template< class Key, class T, class Compare = std::less<Key>>
 	class map {
+		template<class Map> friend struct setAlgebra;
 	public:
 		typedef pair<const Key, T> value_type;
 	private:
 		struct RedBlackNode {
-			value_type *data;
+			typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage;
 			RedBlackNode *left;
 			RedBlackNode *right;
+			RedBlackNode *parent;
 			RedBlackNode *prev;
 			RedBlackNode *next;
 			int colour; //0-red,1-black
+			size_t size; //nodes in this subtree
 
-			RedBlackNode() :data(NULL), left(NULL), right(NULL), prev(NULL), next(NULL), colour(0) {}
-			RedBlackNode(const value_type &element, RedBlackNode *lt = NULL, RedBlackNode *rt = NULL, RedBlackNode *pt = NULL, RedBlackNode *nt = NULL, int h = 0) {
-				data = new value_type(element);
-				left = lt; right = rt;
-				prev = pt; next = nt;
-				colour = h;
-			}
-			~RedBlackNode() { if (data != NULL) delete data;}
+			RedBlackNode() :left(NULL), right(NULL), parent(NULL), prev(NULL), next(NULL), colour(0), size(1) {}
+			value_type & data() { return *reinterpret_cast<value_type *>(&storage); }
 		};
 
-		class linkStack {
+		//nodes are carved from slabs; freed nodes are chained through next
+		class nodePool {
 		private:
-			struct node {
-				RedBlackNode *data;
-				node *next;
-				node(RedBlackNode *x = NULL, node *N = NULL) { data = x; next = N; }
-				~node() {}
+			struct slab {
+				slab *next;
+				size_t cnt;
+			};
+			//split and join leave maps holding nodes from each other's slabs, so slabs
+			//are gathered in refcounted sets that also keep older sets alive
+			struct slabSet {
+				slab *slabs;
+				std::atomic<size_t> refs;
+				slabSet *link[2];
+				memory_resource *res; //of the set and its slabs
+				slabSet(slabSet *a, slabSet *b, memory_resource *r) :slabs(NULL), refs(1), res(r) { link[0] = a; link[1] = b; }
 			};
-			node *elem;
+			static const size_t minSlab = 16;
+			static const size_t maxSlab = 4096;
+			slabSet *owner;
+			RedBlackNode *freeList;
+			size_t nextSlab;
+			memory_resource *res;
 
-		public:
-			linkStack() { elem = NULL; }
-			~linkStack() {
-				node *tmp;
-				while (elem != NULL) {
-					tmp = elem;
-					elem = elem->next;
-					delete tmp;
+			static size_t offset() { return (sizeof(slab) + alignof(RedBlackNode) - 1) / alignof(RedBlackNode) * alignof(RedBlackNode); }
+			static size_t slabAlign() { return alignof(slab) > alignof(RedBlackNode) ? alignof(slab) : alignof(RedBlackNode); }
+			static void drop(slabSet *s) {
+				while (s != NULL && --s->refs == 0) {
+					slab *tmp;
+					while (s->slabs != NULL) {
+						tmp = s->slabs;
+						s->slabs = s->slabs->next;
+						s->res->deallocate(tmp, offset() + tmp->cnt * sizeof(RedBlackNode), slabAlign());
+					}
+					drop(s->link[1]);
+					slabSet *older = s->link[0];
+					memory_resource *r = s->res;
+					s->~slabSet();
+					r->deallocate(s, sizeof(slabSet), alignof(slabSet));
+					s = older;
 				}
 			}
-			bool isEmpty() const { return elem == NULL; }
-			void push(RedBlackNode *x) {
-				node *tmp = new node(x, elem);
-				elem = tmp;
+			RedBlackNode *newSlab(size_t cnt) {
+				//never add to a set other pools hold, or to one on another resource
+				if (owner == NULL || owner->refs > 1 || owner->res != res)
+					owner = new (res->allocate(sizeof(slabSet), alignof(slabSet))) slabSet(owner, NULL, res);
+				slab *s = static_cast<slab *>(res->allocate(offset() + cnt * sizeof(RedBlackNode), slabAlign()));
+				s->next = owner->slabs;
+				s->cnt = cnt;
+				owner->slabs = s;
+				return reinterpret_cast<RedBlackNode *>(reinterpret_cast<char *>(s) + offset());
+			}
+			void grow() {
+				RedBlackNode *nodes = newSlab(nextSlab);
+				for (size_t i = nextSlab; i > 0; i--) {
+					nodes[i - 1].next = freeList;
+					freeList = nodes + i - 1;
+				}
+				if (nextSlab < maxSlab) nextSlab *= 2;
+			}
+
+		public:
+			explicit nodePool(memory_resource *r) :owner(NULL), freeList(NULL), nextSlab(minSlab), res(r) {}
+			~nodePool() { release(); }
+			RedBlackNode *allocate() {
+				if (freeList == NULL) grow();
+				RedBlackNode *p = freeList;
+				freeList = p->next;
+				return new (p) RedBlackNode;
+			}
+			void deallocate(RedBlackNode *p) {
+				p->next = freeList;
+				freeList = p;
+			}
+			//n raw nodes in one slab, bypassing the free list; they are freed by release()
+			RedBlackNode *allocateBlock(size_t n) { return newSlab(n); }
+			memory_resource *resource() const { return res; }
+			void swap(nodePool &other) {
+				std::swap(owner, other.owner);
+				std::swap(freeList, other.freeList);
+				std::swap(nextSlab, other.nextSlab);
+				std::swap(res, other.res);
+			}
+			//take over other's slabs, leaving other empty on the same resource
+			void take(nodePool &other) {
+				release();
+				res = other.res;
+				swap(other);
 			}
-			RedBlackNode* pop(){
-				node *tmp = elem;
-				RedBlackNode *x = tmp->data;
-				elem = elem->next;
-				delete tmp;
-				return x;
+			//keep other's slabs alive as long as this pool, so nodes can move over from other's map.
+			//they stay on other's resource
+			void adopt(nodePool &other) {
+				if (other.owner == NULL || other.owner == owner) return;
+				other.owner->refs++;
+				owner = (owner == NULL ? other.owner : new (res->allocate(sizeof(slabSet), alignof(slabSet))) slabSet(owner, other.owner, res));
 			}
-			RedBlackNode* top() const {
-				if (elem == NULL) return NULL;
-				return elem->data;
+			void release() {//let go of the slabs, values must already be destroyed
+				drop(owner);
+				owner = NULL;
+				freeList = NULL;
+				nextSlab = minSlab;
 			}
 		};
 
+		//nodes of a copy-on-write tree, shared by all maps copied from it
+		struct sharedTree {
+			nodePool pool;
+			std::atomic<size_t> refs;
+			explicit sharedTree(memory_resource *r) :pool(r), refs(1) {}
+		};
+		//the tree of every moved-from map: empty, never written and never freed.
+		//its count is never touched and stays above 1, so the first change to
+		//such a map goes through detach(), which gives the map sentinels of its own
+		struct hollowTree {
+			sharedTree tree;
+			RedBlackNode head, tail;
+			hollowTree() :tree(new_delete_resource()) {
+				tree.refs = 2;
+				head.next = &tail;
+				tail.prev = &head;
+			}
+		};
+		static hollowTree & hollow() {
+			static hollowTree h;
+			return h;
+		}
+
+		//keys looked up together by find_batch and count_batch
+		static const size_t batchGroup = 32;
+
 		RedBlackNode *root;
 		RedBlackNode *head;
 		RedBlackNode *tail;
 		Compare compare;
 		size_t siz;
+		nodePool pool;
+		sharedTree *sh; //NULL unless copy-on-write is on, then the nodes live in sh->pool
 
 	public:
 		class const_iterator;
@@ -88,6 +188,11 @@ namespace sjtu {
 			iterator() { it = NULL; mPtr = NULL; }
 			iterator(map<Key, T, Compare> &m, RedBlackNode *p = NULL) { mPtr = &m; it = p; }
 			iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
+			iterator & operator=(const iterator &other) {
+				it = other.it;
+				mPtr = other.mPtr;
+				return *this;
+			}
 			iterator operator++(int) {
 				if (it == mPtr->tail) throw invalid_iterator();
 				iterator tmp(*this);
@@ -99,26 +204,48 @@ namespace sjtu {
 				it = it->next;
 				return *this;
 			}
+			//stepping back from end() copies a shared tree first
 			iterator operator--(int) {
+				if (it == mPtr->tail) mPtr->detach(it);
 				if (it == mPtr->head->next) throw invalid_iterator();
 				iterator tmp(*this);
 				it = it->prev;
 				return tmp;
 			}
 			iterator & operator--() {
+				if (it == mPtr->tail) mPtr->detach(it);
 				if (it == mPtr->head->next) throw invalid_iterator();
 				it = it->prev;
 				return *this;
 			}
+			//jumps and distances take O(log n) through the subtree sizes
+			iterator & operator+=(ptrdiff_t n) {
+				if (it == mPtr->tail) mPtr->detach(it);
+				it = mPtr->jump(it, n);
+				return *this;
+			}
+			iterator & operator-=(ptrdiff_t n) { return *this += -n; }
+			iterator operator+(ptrdiff_t n) const {
+				iterator tmp(*this);
+				return tmp += n;
+			}
+			iterator operator-(ptrdiff_t n) const {
+				iterator tmp(*this);
+				return tmp -= n;
+			}
+			ptrdiff_t operator-(const iterator &rhs) const {
+				if (rhs.mPtr != mPtr) throw invalid_iterator();
+				return (ptrdiff_t)mPtr->indexOf(it) - (ptrdiff_t)mPtr->indexOf(rhs.it);
+			}
 			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
 			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
 			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
 			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
 			value_type & operator*() const {
 				if (it == mPtr->head || it == mPtr->tail) throw invalid_iterator();
-				else return *(it->data);
+				else return it->data();
 			}
-			value_type* operator->() const noexcept { return it->data; }
+			value_type* operator->() const noexcept { return &(it->data()); }
 		};
 		class const_iterator {
 		public:
@@ -128,6 +255,11 @@ namespace sjtu {
 			const_iterator(const map<Key, T, Compare> &m, RedBlackNode *p = NULL) { mPtr = &m; it = p; }
 			const_iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
 			const_iterator(const const_iterator &other) { it = other.it; mPtr = other.mPtr; }
+			const_iterator & operator=(const const_iterator &other) {
+				it = other.it;
+				mPtr = other.mPtr;
+				return *this;
+			}
 			const_iterator operator++(int) {
 				if (it == mPtr->tail) throw invalid_iterator();
 				const_iterator tmp(*this);
@@ -150,101 +282,134 @@ namespace sjtu {
 				it = it->prev;
 				return *this;
 			}
+			//jumps and distances take O(log n) through the subtree sizes
+			const_iterator & operator+=(ptrdiff_t n) {
+				it = mPtr->jump(it, n);
+				return *this;
+			}
+			const_iterator & operator-=(ptrdiff_t n) { return *this += -n; }
+			const_iterator operator+(ptrdiff_t n) const {
+				const_iterator tmp(*this);
+				return tmp += n;
+			}
+			const_iterator operator-(ptrdiff_t n) const {
+				const_iterator tmp(*this);
+				return tmp -= n;
+			}
+			ptrdiff_t operator-(const const_iterator &rhs) const {
+				if (rhs.mPtr != mPtr) throw invalid_iterator();
+				return (ptrdiff_t)mPtr->indexOf(it) - (ptrdiff_t)mPtr->indexOf(rhs.it);
+			}
 			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
 			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
 			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
 			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
 			value_type & operator*() const {
 				if (it == mPtr->head || it == mPtr->tail) throw invalid_iterator();
-				else return *(it->data);
+				else return it->data();
 			}
-			value_type* operator->() const noexcept { return it->data; }
+			value_type* operator->() const noexcept { return &(it->data()); }
 		};
-		map() {
-			root = NULL;
-			head = new RedBlackNode;
-			tail = new RedBlackNode;
-			head->next = tail;
-			tail->prev = head;
-			siz = 0;
-		}
-		map(const map &other) {
-			head = new RedBlackNode;
-			tail = new RedBlackNode;
-			head->next = tail;
-			tail->prev = head;
-			if (other.empty()) { root = NULL; siz = 0; }
-			else {
-				root = new RedBlackNode;
-				copyNode(root, other.root);
-				siz = other.siz;
-			}
+		//nodes, sentinels and values come from the map's memory resource, get_default_resource()
+		//unless one is given. a copy takes the resource of the map it copies, a map assigned to
+		//keeps its own, moving and swapping carry the resource along with the nodes.
+		//values get no resource of their own: a std::string still allocates with new
+		map() :pool(get_default_resource()) { init(false); }
+		explicit map(memory_resource *r) :pool(r) { init(false); }
+		template<class InputIterator>
+		map(InputIterator first, InputIterator last, memory_resource *r = get_default_resource()) :pool(r) {
+			init(false);
+			assign(first, last);
 		}
+		//a copy-on-write map is shared in O(1), otherwise the values are copied into one block in O(n)
+		map(const map &other) :pool(other.pool.resource()) { copyFrom(other); }
+		map(const map &other, memory_resource *r) :pool(r) { copyFrom(other); }
 		map & operator=(const map &other) {
 			if (this == &other) return *this;
-			this->clear();
-			head = new RedBlackNode;
-			tail = new RedBlackNode;
-			head->next = tail;
-			tail->prev = head;
-			if (other.empty()) { root = NULL; siz = 0; }
-			else {
-				root = new RedBlackNode;
-				copyNode(root, other.root);
-				siz = other.siz;
-			}
+			release();
+			if (canShare(other)) { share(other); return *this; }
+			init(other.sh != NULL && other.sh != &hollow().tree);
+			copyTree(other.root, other.siz);
 			return *this;
 		}
-		~map() {
-			RedBlackNode *p, *q;
-			q = head;
-			while (q != tail) {
-				q = q->next;
-				p = q->prev;
-				delete p;
+		//moving and swapping only exchange the pointers, the nodes stay where they are.
+		//a moved-from map is empty and can be used again; iterators of both maps are invalidated
+		map(map &&other) noexcept :root(other.root), head(other.head), tail(other.tail),
+			compare(other.compare), siz(other.siz), pool(other.pool.resource()), sh(other.sh) {
+			pool.take(other.pool);
+			other.makeHollow();
+		}
+		map & operator=(map &&other) noexcept {
+			if (this == &other) return *this;
+			release();
+			root = other.root;
+			head = other.head;
+			tail = other.tail;
+			compare = other.compare;
+			siz = other.siz;
+			sh = other.sh;
+			pool.take(other.pool);
+			other.makeHollow();
+			return *this;
+		}
+		memory_resource *get_memory_resource() const { return pool.resource(); }
+		void swap(map &other) noexcept {
+			std::swap(root, other.root);
+			std::swap(head, other.head);
+			std::swap(tail, other.tail);
+			std::swap(compare, other.compare);
+			std::swap(siz, other.siz);
+			std::swap(sh, other.sh);
+			pool.swap(other.pool);
+		}
+		~map() { release(); }
+		//with copy-on-write on, copies share this tree until one of them is modified.
+		//only the const interface, end() and lookups that miss leave a shared tree shared;
+		//iterators and references taken before a copy must not be used to write through it,
+		//and an end() taken while shared no longer equals end() once the map is modified
+		void set_copy_on_write(bool on) {
+			if (sh == &hollow().tree) {
+				init(on);
+				return;
+			}
+			if (on == (sh != NULL)) return;
+			if (on) {
+				sh = newShared(pool.resource());
+				sh->pool.swap(pool);
+			}
+			else {
+				detach();
+				pool.swap(sh->pool);
+				deleteShared(sh);
+				sh = NULL;
 			}
-			delete q;
 		}
 		T & at(const Key &key) {
-			RedBlackNode *t = root;
-			while (t != NULL&& (compare(key, t->data->first) || compare(t->data->first, key))) {
-				if (compare(key, t->data->first)) t = t->left;
-				else t = t->right;
-			}
-			if (t != NULL) return t->data->second;
-			else throw index_out_of_bound();
+			RedBlackNode *t = findNode(key);
+			if (t == NULL) throw index_out_of_bound();
+			detach(t);
+			return t->data().second;
 		}
 		const T & at(const Key &key) const {
-			RedBlackNode *t = root;
-			while (t != NULL&& (compare(key, t->data->first) || compare(t->data->first, key))) {
-				if (compare(key, t->data->first)) t = t->left;
-				else t = t->right;
-			}
-			if (t != NULL) return t->data->second;
+			RedBlackNode *t = findNode(key);
+			if (t != NULL) return t->data().second;
 			else throw index_out_of_bound();
 		}
+		//a missing key gets a value-initialized T built in place
 		T & operator[](const Key &key) {
-			RedBlackNode *t = root;
-			while (t != NULL&&(compare(key,t->data->first)||compare(t->data->first,key))){
-				if (compare(key, t->data->first)) t = t->left;
-				else t = t->right;
-			}
-			if (t != NULL) return t->data->second;
-			else {
-				pair<iterator, bool> ans = this->insert(value_type(key, T()));
-				return ans.first.it->data->second;
-			}
+			return this->try_emplace(key).first.it->data().second;
+		}
+		T & operator[](Key &&key) {
+			return this->try_emplace(std::move(key)).first.it->data().second;
 		}
 		const T & operator[](const Key &key) const {
-			RedBlackNode *t = root;
-			while (t != NULL&& (compare(key, t->data->first) || compare(t->data->first, key))) {
-				if (compare(key, t->data->first)) t = t->left;
-				else t = t->right;
-			}
-			if (t != NULL) return t->data->second;
+			RedBlackNode *t = findNode(key);
+			if (t != NULL) return t->data().second;
 			else throw index_out_of_bound();
 		}
+		//an empty map's begin() is its end(), which leaves a shared tree shared
 		iterator begin() {
+			if (siz != 0) detach();
 			iterator p(*this);
 			p.it = head->next;
 			return p;
@@ -254,6 +419,7 @@ namespace sjtu {
 			p.it = head->next;
 			return p;
 		}
+		//leaves a shared tree shared, nothing can be written through end()
 		iterator end() {
 			iterator p(*this);
 			p.it = tail;
@@ -267,50 +433,519 @@ namespace sjtu {
 		bool empty() const { return siz == 0; }
 		size_t size() const { return siz; }
 		void clear() {
-			RedBlackNode *p, *q;
-			q = head->next;
-			while (q != tail) {
-				q = q->next;
-				p = q->prev;
-				delete p;
+			if (sh != NULL && sh->refs > 1) {
+				bool cow = (sh != &hollow().tree);
+				release();
+				init(cow);
+				return;
 			}
+			if (!std::is_trivially_destructible<value_type>::value) {
+				for (RedBlackNode *q = head->next; q != tail; q = q->next) q->data().~value_type();
+			}
+			nodes().release();
 			head->next = tail;
 			tail->prev = head;
 			root = NULL;
 			siz = 0;
 		}
+		//sorted input is linked straight into a balanced tree, other input is merge sorted first
+		template<class InputIterator>
+		void assign(InputIterator first, InputIterator last) {
+			clear();
+			RedBlackNode *list = NULL, **end = &list, *p;
+			size_t n = 0;
+			try {
+				for (; first != last; ++first) {
+					*end = newNode(*first);
+					end = &((*end)->next);
+					n++;
+				}
+			}
+			catch (...) {
+				while (list != NULL) {
+					p = list;
+					list = list->next;
+					deleteNode(p);
+				}
+				throw;
+			}
+			if (n == 0) return;
+			bool sorted = true;
+			for (p = list; p->next != NULL && sorted; p = p->next)
+				sorted = compare(p->data().first, p->next->data().first);
+			if (!sorted) {
+				p = list;
+				list = sortList(p, n);
+				for (p = list; p->next != NULL;) {//keep the first of equal keys
+					if (compare(p->data().first, p->next->data().first)) { p = p->next; continue; }
+					RedBlackNode *q = p->next;
+					p->next = q->next;
+					deleteNode(q);
+					n--;
+				}
+			}
+			linkList(list, n);
+		}
 		pair<iterator, bool> insert(const value_type &x) {
-			pair<iterator, bool> ans;
-			ans.first.mPtr = this;
-			linkStack path;//path·
-			RedBlackNode *t, *parent;
-
-			if (root == NULL) {//ڿϲ
-				root = new RedBlackNode(x, NULL, NULL, head, tail, 1);
-				siz++;
-				head->next = root;
-				tail->prev = root;
-				ans.first.it = root;
-				ans.second = true;
-				return ans;
+			detach();
+			RedBlackNode *parent;
+			bool toLeft;
+			RedBlackNode *t = findPosition(x.first, parent, toLeft);
+			if (t != NULL) return pair<iterator, bool>(iterator(*this, t), false);//ҵظ㣬
+			t = newNode(x);
+			linkNode(t, parent, toLeft);
+			return pair<iterator, bool>(iterator(*this, t), true);
+		}
+		pair<iterator, bool> insert(value_type &&x) {
+			detach();
+			RedBlackNode *parent;
+			bool toLeft;
+			RedBlackNode *t = findPosition(x.first, parent, toLeft);
+			if (t != NULL) return pair<iterator, bool>(iterator(*this, t), false);
+			t = newNode(std::move(x));
+			linkNode(t, parent, toLeft);
+			return pair<iterator, bool>(iterator(*this, t), true);
+		}
+		//the value is built before the key is known, and destroyed again if the key is present
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			detach();
+			RedBlackNode *parent;
+			bool toLeft;
+			RedBlackNode *t = newNode(std::forward<Args>(args)...);
+			RedBlackNode *old = findPosition(t->data().first, parent, toLeft);
+			if (old != NULL) {
+				deleteNode(t);
+				return pair<iterator, bool>(iterator(*this, old), false);
 			}
-
-			t = root;
-			while (t != NULL && (compare(t->data->first, x.first) || compare(x.first, t->data->first))) {//ѰҲλã·Ϣջ
-				path.push(t);
-				if (compare(t->data->first, x.first)) t = t->right;
+			linkNode(t, parent, toLeft);
+			return pair<iterator, bool>(iterator(*this, t), true);
+		}
+		//args are only used when key is missing; then the mapped value is built from them in place
+		template<class... Args>
+		pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+			return tryEmplace(key, std::forward<Args>(args)...);
+		}
+		template<class... Args>
+		pair<iterator, bool> try_emplace(Key &&key, Args&&... args) {
+			return tryEmplace(std::move(key), std::forward<Args>(args)...);
+		}
+		//O(1) besides rebalancing when x belongs right before hint, e.g. end() for ascending keys
+		iterator insert(iterator hint, const value_type &x) {
+			if (hint.mPtr != this) throw invalid_iterator();
+			detach(hint.it);
+			RedBlackNode *parent;
+			bool toLeft;
+			RedBlackNode *t = hintPosition(hint.it, x.first, parent, toLeft);
+			if (t != NULL) return iterator(*this, t);
+			t = newNode(x);
+			linkNode(t, parent, toLeft);
+			return iterator(*this, t);
+		}
+		template<class... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			if (hint.mPtr != this) throw invalid_iterator();
+			detach(hint.it);
+			RedBlackNode *parent;
+			bool toLeft;
+			RedBlackNode *t = newNode(std::forward<Args>(args)...);
+			RedBlackNode *old = hintPosition(hint.it, t->data().first, parent, toLeft);
+			if (old != NULL) {
+				deleteNode(t);
+				return iterator(*this, old);
+			}
+			linkNode(t, parent, toLeft);
+			return iterator(*this, t);
+		}
+		void erase(iterator pos) {
+			if (this->empty()) throw invalid_iterator();
+			if (pos.mPtr != this) throw invalid_iterator();
+			if (pos.it == tail) throw index_out_of_bound();
+			detach(pos.it);
+			eraseNode(pos.it);
+		}
+		void erase(iterator first, iterator last) {
+			if (first.mPtr != this || last.mPtr != this) throw invalid_iterator();
+			detach(first.it, last.it);
+			while (first.it != last.it) {
+				if (first.it == tail) throw invalid_iterator();
+				RedBlackNode *t = first.it;
+				first.it = t->next;
+				eraseNode(t);
+			}
+		}
+		size_t erase(const Key &key) {
+			RedBlackNode *t = findNode(key);
+			if (t == NULL) return 0;
+			detach(t);
+			eraseNode(t);
+			return 1;
+		}
+		//keys not less than key move to the returned map in O(log n), without copying values
+		map split(const Key &key) {
+			map right(pool.resource());
+			detach();
+			RedBlackNode *first = lowerNode(key);
+			if (first == tail) return right;
+			RedBlackNode *last = tail->prev, *lastLeft = first->prev, *l, *r;
+			int bhl, bhr;
+			splitTree(root, blackHeight(root), key, l, bhl, r, bhr);
+			right.nodes().adopt(nodes());
+			root = l;
+			siz = sizeOf(l);
+			right.root = r;
+			right.siz = sizeOf(r);
+			right.head->next = first;
+			first->prev = right.head;
+			last->next = right.tail;
+			right.tail->prev = last;
+			lastLeft->next = tail;
+			tail->prev = lastLeft;
+			return right;
+		}
+		//move all of right's elements to the end of this map in O(log n);
+		//right's keys must all be greater than the keys here
+		void join(map &right) {
+			if (&right == this || right.empty()) return;
+			if (!empty() && !compare(tail->prev->data().first, right.head->next->data().first)) throw runtime_error();
+			detach();
+			right.detach();
+			joinWith(right, false);
+		}
+		//move in other's elements whose keys are missing here, the rest stay in other.
+		//maps whose keys don't interleave are joined in O(log n), otherwise nodes are relinked one by one
+		void merge(map &other) {
+			if (&other == this || other.empty()) return;
+			detach();
+			other.detach();
+			if (empty() || compare(tail->prev->data().first, other.head->next->data().first)) { joinWith(other, false); return; }
+			if (compare(other.tail->prev->data().first, head->next->data().first)) { joinWith(other, true); return; }
+			nodes().adopt(other.nodes());
+			RedBlackNode *next, *parent;
+			bool toLeft;
+			for (RedBlackNode *t = other.head->next; t != other.tail; t = next) {
+				next = t->next;
+				if (findPosition(t->data().first, parent, toLeft) != NULL) continue;
+				other.unlinkNode(t);
+				t->left = t->right = NULL;
+				t->colour = 0;
+				t->size = 1;
+				linkNode(t, parent, toLeft);
+			}
+		}
+		size_t count(const Key &key) const {
+			RedBlackNode *t = findNode(key);
+			if (t == NULL) return 0;
+			else return 1;
+		}
+		//out[i] = find(keys[i]) for i < n. the descents of a group of keys take turns and
+		//every next node is prefetched, so their cache misses overlap instead of queueing
+		void find_batch(const Key *keys, size_t n, iterator *out) {
+			detach();
+			RedBlackNode *found[batchGroup];
+			for (size_t base = 0; base < n; base += batchGroup) {
+				size_t g = (n - base < batchGroup ? n - base : batchGroup);
+				findGroup(keys + base, g, found);
+				for (size_t i = 0; i < g; i++) out[base + i] = iterator(*this, found[i] != NULL ? found[i] : tail);
+			}
+		}
+		void find_batch(const Key *keys, size_t n, const_iterator *out) const {
+			RedBlackNode *found[batchGroup];
+			for (size_t base = 0; base < n; base += batchGroup) {
+				size_t g = (n - base < batchGroup ? n - base : batchGroup);
+				findGroup(keys + base, g, found);
+				for (size_t i = 0; i < g; i++) out[base + i] = const_iterator(*this, found[i] != NULL ? found[i] : tail);
+			}
+		}
+		//out[i] = count(keys[i]) for i < n, out may be NULL; returns how many keys are present
+		size_t count_batch(const Key *keys, size_t n, size_t *out = NULL) const {
+			RedBlackNode *found[batchGroup];
+			size_t total = 0;
+			for (size_t base = 0; base < n; base += batchGroup) {
+				size_t g = (n - base < batchGroup ? n - base : batchGroup);
+				findGroup(keys + base, g, found);
+				for (size_t i = 0; i < g; i++) {
+					if (out != NULL) out[base + i] = (found[i] != NULL ? 1 : 0);
+					if (found[i] != NULL) total++;
+				}
+			}
+			return total;
+		}
+		//an immutable copy laid out for fast lookups, see frozen_map.hpp
+		frozen_map<Key, T, Compare> freeze() const {
+			return frozen_map<Key, T, Compare>(cbegin(), siz);
+		}
+		//write an image of the map that mapped_map serves without reading it in, see mapped_map.hpp.
+		//Key and T must be trivially copyable; throws runtime_error if the file cannot be written
+		void save(const char *path) const { freeze().save(path); }
+		//for other types a serializer converts each element to trivially copyable ones:
+		//	typedef ... key_type; typedef ... mapped_type;
+		//	key_type key(const Key &) const; mapped_type value(const T &) const;
+		//the image opens as a mapped_map<key_type, mapped_type, C>, where C must order
+		//the converted keys as Compare orders the original ones
+		template<class Serializer>
+		void save(const char *path, const Serializer &s) const {
+			typedef frozen_map<typename Serializer::key_type, typename Serializer::mapped_type> image;
+			image(encoded<Serializer>(cbegin(), s), siz).save(path);
+		}
+		//binary checkpoints in the format of serial.hpp. deserialize replaces the contents,
+		//linking the sorted elements straight into a balanced tree in O(n); on input that
+		//ends early or is out of order it throws runtime_error and leaves the map empty
+		void serialize(std::ostream &os) const {
+			serialWriter out(os);
+			writeTo(out);
+			out.finish();
+		}
+		//appends to buf
+		void serialize(std::vector<char> &buf) const {
+			serialWriter out(buf);
+			writeTo(out);
+		}
+		void deserialize(std::istream &is) {
+			streamReader in(is);
+			readFrom(in);
+		}
+		//returns how many bytes of data were read
+		size_t deserialize(const char *data, size_t len) {
+			bufferReader in(data, len);
+			readFrom(in);
+			return in.position() - data;
+		}
+		//the k-th smallest element, counting from 0
+		iterator nth(size_t k) {
+			if (k >= siz) throw index_out_of_bound();
+			detach();
+			return iterator(*this, select(k));
+		}
+		const_iterator nth(size_t k) const {
+			if (k >= siz) throw index_out_of_bound();
+			return const_iterator(*this, select(k));
+		}
+		//the number of keys less than key
+		size_t rank(const Key &key) const {
+			size_t k = 0;
+			for (RedBlackNode *t = root; t != NULL;) {
+				if (compare(t->data().first, key)) { k += sizeOf(t->left) + 1; t = t->right; }
 				else t = t->left;
 			}
-			if (t != NULL) {//ҵظ㣬
-				ans.first.it = t;
-				ans.second = false;
-				return ans;
+			return k;
+		}
+		//a shared tree is only copied when the key is there
+		iterator find(const Key &key) {
+			RedBlackNode *t = findNode(key);
+			if (t == NULL) return this->end();
+			detach(t);
+			return iterator(*this, t);
+		}
+		const_iterator find(const Key &key) const {
+			RedBlackNode *t = findNode(key);
+			if (t == NULL) return this->cend();
+			else return const_iterator(*this, t);
+		}
+		iterator lower_bound(const Key &key) {
+			RedBlackNode *t = lowerNode(key);
+			if (t != tail) detach(t);
+			return iterator(*this, t);
+		}
+		const_iterator lower_bound(const Key &key) const { return const_iterator(*this, lowerNode(key)); }
+		iterator upper_bound(const Key &key) {
+			RedBlackNode *t = upperNode(key);
+			if (t != tail) detach(t);
+			return iterator(*this, t);
+		}
+		const_iterator upper_bound(const Key &key) const { return const_iterator(*this, upperNode(key)); }
+		pair<iterator, iterator> equal_range(const Key &key) {
+			RedBlackNode *t = lowerNode(key);
+			if (t != tail) detach(t);
+			if (t != tail && !compare(key, t->data().first)) return pair<iterator, iterator>(iterator(*this, t), iterator(*this, t->next));
+			return pair<iterator, iterator>(iterator(*this, t), iterator(*this, t));
+		}
+		pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+			RedBlackNode *t = lowerNode(key);
+			if (t != tail && !compare(key, t->data().first)) return pair<const_iterator, const_iterator>(const_iterator(*this, t), const_iterator(*this, t->next));
+			return pair<const_iterator, const_iterator>(const_iterator(*this, t), const_iterator(*this, t));
+		}
+		//the elements in [first, last), walked along the thread
+		template<class Iterator>
+		class range_view {
+		public:
+			range_view(const Iterator &first, const Iterator &last) :first(first), last(last) {}
+			Iterator begin() const { return first; }
+			Iterator end() const { return last; }
+			bool empty() const { return first == last; }
+			size_t size() const { return last - first; }
+		private:
+			Iterator first, last;
+		};
+		//keys in [lo, hi): two descents, then O(1) per element
+		range_view<iterator> range(const Key &lo, const Key &hi) {
+			RedBlackNode *first = lowerNode(lo);
+			RedBlackNode *last = compare(lo, hi) ? lowerNode(hi) : first;
+			if (first != tail) detach(first, last);
+			return range_view<iterator>(iterator(*this, first), iterator(*this, last));
+		}
+		range_view<const_iterator> range(const Key &lo, const Key &hi) const {
+			RedBlackNode *first = lowerNode(lo);
+			RedBlackNode *last = compare(lo, hi) ? lowerNode(hi) : first;
+			return range_view<const_iterator>(const_iterator(*this, first), const_iterator(*this, last));
+		}
+
+	private:
+		//walks the map yielding elements converted by a serializer for save()
+		template<class Serializer>
+		class encoded {
+		public:
+			encoded(const const_iterator &it, const Serializer &s) :it(it), s(&s) {}
+			pair<typename Serializer::key_type, typename Serializer::mapped_type> operator*() const {
+				return pair<typename Serializer::key_type, typename Serializer::mapped_type>(s->key(it->first), s->value(it->second));
+			}
+			encoded & operator++() {
+				++it;
+				return *this;
+			}
+		private:
+			const_iterator it;
+			const Serializer *s;
+		};
+		void writeTo(serialWriter &out) const {
+			out.putSize(siz);
+			for (RedBlackNode *p = head->next; p != tail; p = p->next) {
+				serial<Key>::write(out, p->data().first);
+				serial<T>::write(out, p->data().second);
+			}
+		}
+		template<class In>
+		void readFrom(In &in) {
+			clear();
+			uint64_t n = in.getSize();
+			RedBlackNode *list = NULL, **end = &list, *p = NULL;
+			size_t cnt = 0;
+			try {
+				for (; cnt < n; cnt++) {
+					Key key = serial<Key>::read(in);
+					T value = serial<T>::read(in);
+					RedBlackNode *q = newNode(std::move(key), std::move(value));
+					*end = q;
+					end = &q->next;
+					if (p != NULL && !compare(p->data().first, q->data().first)) throw runtime_error();
+					p = q;
+				}
+			}
+			catch (...) {
+				while (list != NULL) {
+					p = list;
+					list = list->next;
+					deleteNode(p);
+				}
+				throw;
+			}
+			linkList(list, cnt);
+		}
+		//lower-bound descent: one comparison per level and a final equality check
+		RedBlackNode *findNode(const Key &key) const {
+			RedBlackNode *t = lowerNode(key);
+			if (t != tail && !compare(key, t->data().first)) return t;
+			return NULL;
+		}
+		//findNode for g <= batchGroup keys at once, one level of every descent per round
+		void findGroup(const Key *keys, size_t g, RedBlackNode **found) const {
+			RedBlackNode *t[batchGroup], *cand[batchGroup];
+			for (size_t i = 0; i < g; i++) {
+				t[i] = root;
+				cand[i] = tail;
+			}
+			for (bool active = (root != NULL); active;) {
+				active = false;
+				for (size_t i = 0; i < g; i++) {
+					RedBlackNode *p = t[i];
+					if (p == NULL) continue;
+					if (compare(p->data().first, keys[i])) p = p->right;
+					else { cand[i] = p; p = p->left; }
+					if (p != NULL) {
+						prefetch(p);
+						active = true;
+					}
+					t[i] = p;
+				}
+			}
+			for (size_t i = 0; i < g; i++)
+				found[i] = (cand[i] != tail && !compare(keys[i], cand[i]->data().first)) ? cand[i] : NULL;
+		}
+		static void prefetch(const void *p) {
+#if defined(__GNUC__)
+			__builtin_prefetch(p);
+#endif
+		}
+		//the first node not less than key, tail if there is none
+		RedBlackNode *lowerNode(const Key &key) const {
+			RedBlackNode *t = root, *cand = tail;
+			while (t != NULL) {
+				if (compare(t->data().first, key)) t = t->right;
+				else { cand = t; t = t->left; }
+			}
+			return cand;
+		}
+		//the first node greater than key, tail if there is none
+		RedBlackNode *upperNode(const Key &key) const {
+			RedBlackNode *t = root, *cand = tail;
+			while (t != NULL) {
+				if (compare(key, t->data().first)) { cand = t; t = t->left; }
+				else t = t->right;
+			}
+			return cand;
+		}
+		//the node holding key, or NULL with the place key would be linked at
+		RedBlackNode *findPosition(const Key &key, RedBlackNode * &parent, bool &toLeft) const {
+			RedBlackNode *t = root, *cand = NULL;
+			parent = NULL;
+			toLeft = false;
+			while (t != NULL) {//ѰҲλ
+				parent = t;
+				toLeft = !compare(t->data().first, key);
+				if (toLeft) { cand = t; t = t->left; }
+				else t = t->right;
+			}
+			if (cand != NULL && !compare(key, cand->data().first)) return cand;
+			return NULL;
+		}
+		//as findPosition, but tries the gap right before h first
+		RedBlackNode *hintPosition(RedBlackNode *h, const Key &key, RedBlackNode * &parent, bool &toLeft) const {
+			RedBlackNode *p = h->prev;
+			if ((h == tail || compare(key, h->data().first)) && (p == head || compare(p->data().first, key))) {
+				if (h != tail && h->left == NULL) { parent = h; toLeft = true; }
+				else if (p != head) { parent = p; toLeft = false; }//phǰûҶ
+				else { parent = NULL; toLeft = false; }
+				return NULL;
+			}
+			return findPosition(key, parent, toLeft);
+		}
+		template<class K, class... Args>
+		pair<iterator, bool> tryEmplace(K &&key, Args&&... args) {
+			detach();
+			RedBlackNode *parent;
+			bool toLeft;
+			RedBlackNode *t = findPosition(key, parent, toLeft);
+			if (t != NULL) return pair<iterator, bool>(iterator(*this, t), false);
+			t = newNode(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+				std::forward_as_tuple(std::forward<Args>(args)...));
+			linkNode(t, parent, toLeft);
+			return pair<iterator, bool>(iterator(*this, t), true);
+		}
+		//link a new node under parent (NULL for an empty tree) and rebalance
+		void linkNode(RedBlackNode *t, RedBlackNode *parent, bool toLeft) {
+			siz++;
+			t->parent = parent;
+			for (RedBlackNode *p = parent; p != NULL; p = p->parent) p->size++;
+			if (parent == NULL) {//ڿϲ
+				root = t;
+				root->colour = 1;
+				t->prev = head;
+				t->next = tail;
+				head->next = t;
+				tail->prev = t;
+				return;
 			}
-			//ִв
-			t = new RedBlackNode(x, NULL, NULL, NULL, NULL);
-			siz++; 
-			parent = path.pop();
-			if (compare(x.first, parent->data->first)) {
+			if (toLeft) {
 				parent->left = t;
 				t->next = parent;
 				t->prev = parent->prev;
@@ -324,180 +959,458 @@ namespace sjtu {
 				parent->next = t;
 				t->next->prev = t;
 			}
-
-			ans.first.it = t;
-			ans.second = true;
-
-			if (parent->colour == 0) {//㲻ǺɫҪ
-									  //ѹջУӲ㿪ʼƽ
-				path.push(parent);
-				insertReBalance(t, path);
+			if (parent->colour == 0) insertReBalance(t, root);//㲻ǺɫҪ
+		}
+		template<class... Args>
+		RedBlackNode *newNode(Args&&... args) {
+			RedBlackNode *p = nodes().allocate();
+			try { new (&p->storage) value_type(std::forward<Args>(args)...); }
+			catch (...) { nodes().deallocate(p); throw; }
+			return p;
+		}
+		void deleteNode(RedBlackNode *p) {
+			p->data().~value_type();
+			nodes().deallocate(p);
+		}
+		//stable merge sort of the first n nodes of list, which is advanced past them
+		RedBlackNode *sortList(RedBlackNode * &list, size_t n) {
+			if (n == 1) {
+				RedBlackNode *p = list;
+				list = list->next;
+				p->next = NULL;
+				return p;
+			}
+			RedBlackNode *a = sortList(list, n / 2);
+			RedBlackNode *b = sortList(list, n - n / 2);
+			RedBlackNode *res = NULL, **end = &res;
+			while (a != NULL && b != NULL) {
+				if (compare(b->data().first, a->data().first)) { *end = b; b = b->next; }
+				else { *end = a; a = a->next; }
+				end = &((*end)->next);
 			}
-			return ans;
+			*end = (a != NULL ? a : b);
+			return res;
 		}
-		void erase(iterator pos) {
-			if (this->empty()) throw invalid_iterator();
-			if (pos.mPtr != this) throw invalid_iterator();
-			if (pos == this->end()) throw index_out_of_bound();
-
-			linkStack path;
-			RedBlackNode *t = root, *old, *parent = NULL;
-			bool flag = false;
-
-			while (t != NULL && (compare(t->data->first, (*pos).first) || compare((*pos).first, t->data->first))) {//Ѱɾ㣬·
-				path.push(t);
-				if (compare((*pos).first, t->data->first)) t = t->left;
-				else t = t->right;
+		//all leaves of a tree split this way sit on the last two levels,
+		//so colouring the deepest level red keeps every path equally black
+		static RedBlackNode *buildTree(RedBlackNode * &list, size_t n, int depth, int redDepth) {
+			if (n == 0) return NULL;
+			RedBlackNode *lt = buildTree(list, (n - 1) / 2, depth + 1, redDepth);
+			RedBlackNode *t = list;
+			list = list->next;
+			t->left = lt;
+			if (lt != NULL) lt->parent = t;
+			t->right = buildTree(list, n - 1 - (n - 1) / 2, depth + 1, redDepth);
+			if (t->right != NULL) t->right->parent = t;
+			t->colour = (depth == redDepth && depth != 0) ? 0 : 1;
+			t->size = n;
+			return t;
+		}
+		//black nodes on each path from t down, 0 for NULL
+		static int blackHeight(RedBlackNode *t) {
+			int h = 0;
+			for (; t != NULL; t = t->left) h += t->colour;
+			return h;
+		}
+		//join the detached subtrees l < k < r, whose black heights are bhl and bhr, into one
+		//tree and return its root; bh gets its black height. O(|bhl - bhr| + 1)
+		static RedBlackNode *joinTree(RedBlackNode *l, int bhl, RedBlackNode *k, RedBlackNode *r, int bhr, int &bh) {
+			if (l != NULL) {
+				l->parent = NULL;
+				if (l->colour == 0) { l->colour = 1; bhl++; }
+			}
+			if (r != NULL) {
+				r->parent = NULL;
+				if (r->colour == 0) { r->colour = 1; bhr++; }
+			}
+			k->parent = NULL;
+			if (bhl == bhr) {
+				k->left = l;
+				k->right = r;
+				if (l != NULL) l->parent = k;
+				if (r != NULL) r->parent = k;
+				k->colour = 1;
+				k->size = sizeOf(l) + sizeOf(r) + 1;
+				bh = bhl + 1;
+				return k;
+			}
+			//hang k in place of the first black node down the spine of the higher tree
+			//whose black height matches the lower one, then fix it up like an insert
+			RedBlackNode *top, *c, *p = NULL;
+			int h;
+			if (bhl > bhr) {
+				top = c = l;
+				for (h = bhl; c != NULL && (h > bhr || c->colour == 0); c = c->right) { h -= c->colour; p = c; }
+				p->right = k;
+				k->left = c;
+				k->right = r;
+				if (r != NULL) r->parent = k;
 			}
-			if (t == NULL) return;//ûҵɾ㣬ɾ
-			 //㲢
-			RedBlackNode *parent2 = NULL;
-			if (t->left != NULL&&t->right != NULL) {
-				parent2 = path.top();
-				path.push(t->next);
-				old = t;
-				t = t->right;
-				while (t->left != NULL) {
-					path.push(t);
-					t = t->left;
+			else {
+				top = c = r;
+				for (h = bhr; c != NULL && (h > bhl || c->colour == 0); c = c->left) { h -= c->colour; p = c; }
+				p->left = k;
+				k->left = l;
+				k->right = c;
+				if (l != NULL) l->parent = k;
+			}
+			if (c != NULL) c->parent = k;
+			k->parent = p;
+			k->colour = 0;
+			k->size = sizeOf(k->left) + sizeOf(k->right) + 1;
+			for (size_t add = k->size - sizeOf(c); p != NULL; p = p->parent) p->size += add;
+			bh = (bhl > bhr ? bhl : bhr);
+			if (k->parent->colour == 0 && insertReBalance(k, top)) bh++;
+			return top;
+		}
+		//split the subtree t of black height bh into keys less than key (l) and the rest (r).
+		//with found given, the node holding key is taken out to *found (NULL if missing) instead of going to r.
+		//the joins along the search path telescope to O(log n). keys are only compared on the way down,
+		//so a throwing comparison leaves t as it was
+		void splitTree(RedBlackNode *t, int bh, const Key &key, RedBlackNode * &l, int &bhl, RedBlackNode * &r, int &bhr,
+			RedBlackNode **found = NULL) const {
+			RedBlackNode *path[128];
+			int heights[128], depth = 0;
+			bool toLeft[128];
+			l = r = NULL;
+			bhl = bhr = 0;
+			if (found != NULL) *found = NULL;
+			while (t != NULL) {
+				int h = bh - t->colour;//black height of t's children
+				if (!compare(t->data().first, key) && !compare(key, t->data().first)) {
+					l = t->left;
+					bhl = h;
+					RedBlackNode *right = t->right;
+					if (found == NULL) r = joinTree(NULL, 0, t, right, h, bhr);
+					else {
+						*found = t;
+						r = right;
+						bhr = h;
+					}
+					break;
 				}
-				flag = true;
+				path[depth] = t;
+				heights[depth] = h;
+				toLeft[depth] = compare(key, t->data().first);
+				t = toLeft[depth++] ? t->left : t->right;
+				bh = h;
 			}
-
-			//ִɾ
-			siz--;
-			if (t == root) {//ɾ
-				root = (t->left ? t->left : t->right);
-				if (root != NULL) root->colour = 1;
-				t->prev->next = t->next;
-				t->next->prev = t->prev;
-				delete t;
-				return;
+			while (depth > 0) {
+				t = path[--depth];
+				if (toLeft[depth]) r = joinTree(r, bhr, t, t->right, heights[depth], bhr);
+				else l = joinTree(t->left, heights[depth], t, l, bhl, bhl);
 			}
-			//ɾҶֻһӵĽ
-			parent = path.pop();
-			old = t;
-			t = (t->left ? t->left : t->right);
-			if (parent->left == old) parent->left = t;
-			else parent->right = t;
-
-			bool flag2 = (old->colour == 0);
-			if (flag) {
-				RedBlackNode *del = old->prev;
-				if (parent2 == NULL) root = old;
-				else if (parent2->left == del) parent2->left = old;
-				else parent2->right = old;
-
-				if (del->right == old) old->right = del->right->right;
-				else old->right = del->right;
-
-				old->left = del->left;
-				old->colour = del->colour;
-				old->prev = del->prev;
-				del->prev->next = old;
-				delete del;
+			if (l != NULL) {
+				l->parent = NULL;
+				if (l->colour == 0) { l->colour = 1; bhl++; }
+			}
+			if (r != NULL) r->parent = NULL;
+		}
+		//take the first node of the subtree t out to first, the rest goes to r; no comparisons
+		static void splitFirst(RedBlackNode *t, int bh, RedBlackNode * &first, RedBlackNode * &r, int &bhr) {
+			RedBlackNode *path[128];
+			int heights[128], depth = 0;
+			for (; t->left != NULL; t = t->left) {
+				bh -= t->colour;
+				path[depth] = t;
+				heights[depth++] = bh;
+			}
+			first = t;
+			r = t->right;
+			bhr = bh - t->colour;
+			while (depth > 0) {
+				t = path[--depth];
+				r = joinTree(r, bhr, t, t->right, heights[depth], bhr);
+			}
+			if (r != NULL) r->parent = NULL;
+		}
+		//link other's elements, all less (before) or all greater than ours, into this tree
+		void joinWith(map &other, bool before) {
+			nodes().adopt(other.nodes());
+			RedBlackNode *k = before ? other.tail->prev : other.head->next;
+			other.unlinkNode(k);
+			int bh;
+			if (before) {
+				root = joinTree(other.root, blackHeight(other.root), k, root, blackHeight(root), bh);
+				k->next = head->next;
+				k->next->prev = k;
+				if (other.siz == 0) { head->next = k; k->prev = head; }
+				else {
+					head->next = other.head->next;
+					head->next->prev = head;
+					k->prev = other.tail->prev;
+					k->prev->next = k;
+				}
 			}
 			else {
-				old->prev->next = old->next;
-				old->next->prev = old->prev;
-				delete old;
+				root = joinTree(root, blackHeight(root), k, other.root, blackHeight(other.root), bh);
+				k->prev = tail->prev;
+				k->prev->next = k;
+				if (other.siz == 0) { tail->prev = k; k->next = tail; }
+				else {
+					k->next = other.head->next;
+					k->next->prev = k;
+					tail->prev = other.tail->prev;
+					tail->prev->next = tail;
+				}
 			}
-			if (flag2) return;
-			if (t != NULL) { t->colour = 1; return; }//һ
-			 //ɾǺڶӣʼ
-			path.push(parent);
-			removeReBalance(t, path);
+			siz += other.siz + 1;
+			other.root = NULL;
+			other.siz = 0;
+			other.head->next = other.tail;
+			other.tail->prev = other.head;
 		}
-		size_t count(const Key &key) const {
-			RedBlackNode *t = root;
-			while (t != NULL && (compare(t->data->first, key) || compare(key, t->data->first))) {
-				if (compare(key, t->data->first)) t = t->left;
-				else t = t->right;
+		//link a sorted NULL-terminated chain of n nodes into the empty tree
+		void linkList(RedBlackNode *list, size_t n) {
+			if (n == 0) return;
+			int redDepth = 0;
+			for (size_t m = n; m > 1; m >>= 1) redDepth++;
+			RedBlackNode *p = list;
+			root = buildTree(p, n, 0, redDepth);
+			siz = n;
+			head->next = list;
+			list->prev = head;
+			for (p = list; p->next != NULL; p = p->next) p->next->prev = p;
+			p->next = tail;
+			tail->prev = p;
+		}
+		//copy the tree under src into the empty tree, a and b are moved to their copies.
+		//an in-order walk with an explicit stack, a red-black tree is never deeper than 2log2(n+1) < 128;
+		//the copies are laid out in one block, in preorder like the source walk
+		void copyTree(RedBlackNode *src, size_t n, RedBlackNode **a = NULL, RedBlackNode **b = NULL) {
+			if (n == 0) return;
+			RedBlackNode *block = nodes().allocateBlock(n);
+			RedBlackNode *oldStack[128], *newStack[128];
+			RedBlackNode *o = src, *t, *parent = NULL, **slot = &root, *last = head;
+			size_t k = 0;
+			int sp = 0;
+			try {
+				for (;;) {
+					for (; o != NULL; o = o->left) {
+						t = copyOne(block + k++, o, a, b);
+						t->parent = parent;
+						*slot = t;
+						oldStack[sp] = o;
+						newStack[sp++] = t;
+						parent = t;
+						slot = &t->left;
+					}
+					if (sp == 0) break;
+					o = oldStack[--sp];
+					t = newStack[sp];
+					t->prev = last;
+					last->next = t;
+					last = t;
+					parent = t;
+					slot = &t->right;
+					o = o->right;
+				}
 			}
-			if (t == NULL) return 0;
-			else return 1;
+			catch (...) {//block[k - 1] holds no value
+				if (!std::is_trivially_destructible<value_type>::value) {
+					for (size_t i = 0; i + 1 < k; i++) block[i].data().~value_type();
+				}
+				nodes().release();
+				root = NULL;
+				head->next = tail;
+				throw;
+			}
+			last->next = tail;
+			tail->prev = last;
+			siz = n;
 		}
-		iterator find(const Key &key) {
-			RedBlackNode *t = root;
-			while (t != NULL && (compare(t->data->first, key) || compare(key, t->data->first))) {
-				if (compare(key, t->data->first)) t = t->left;
-				else t = t->right;
+		RedBlackNode *copyOne(RedBlackNode *t, RedBlackNode *o, RedBlackNode **a, RedBlackNode **b) {
+			new (t) RedBlackNode;
+			new (&t->storage) value_type(o->data());
+			t->colour = o->colour;
+			t->size = o->size;
+			if (a != NULL && *a == o) *a = t;
+			if (b != NULL && *b == o) *b = t;
+			return t;
+		}
+		nodePool & nodes() { return sh != NULL ? sh->pool : pool; }
+		//sentinels and shared trees come from the map's resource and go back to their pool's,
+		//which is the same one: maps only share a tree on equal resources
+		static RedBlackNode *newSentinel(memory_resource *r) {
+			return new (r->allocate(sizeof(RedBlackNode), alignof(RedBlackNode))) RedBlackNode;
+		}
+		static sharedTree *newShared(memory_resource *r) {
+			return new (r->allocate(sizeof(sharedTree), alignof(sharedTree))) sharedTree(r);
+		}
+		static void deleteShared(sharedTree *t) {
+			memory_resource *r = t->pool.resource();
+			t->~sharedTree();
+			r->deallocate(t, sizeof(sharedTree), alignof(sharedTree));
+		}
+		void init(bool cow) {
+			memory_resource *r = pool.resource();
+			root = NULL;
+			head = newSentinel(r);
+			tail = newSentinel(r);
+			head->next = tail;
+			tail->prev = head;
+			siz = 0;
+			sh = cow ? newShared(r) : NULL;
+		}
+		//a moved-from map's empty tree is fine anywhere
+		bool canShare(const map &other) const {
+			return other.sh != NULL && (other.sh == &hollow().tree || other.sh->pool.resource()->is_equal(*pool.resource()));
+		}
+		void copyFrom(const map &other) {
+			if (canShare(other)) { share(other); return; }
+			init(other.sh != NULL && other.sh != &hollow().tree);
+			try { copyTree(other.root, other.siz); }
+			catch (...) { release(); throw; }
+		}
+		void share(const map &other) {
+			sh = other.sh;
+			if (sh != &hollow().tree) sh->refs++;
+			root = other.root;
+			head = other.head;
+			tail = other.tail;
+			siz = other.siz;
+		}
+		//destroy the values between head and tail, then free their nodes and the sentinels
+		static void destroy(RedBlackNode *head, RedBlackNode *tail, nodePool &p) {
+			if (!std::is_trivially_destructible<value_type>::value) {
+				for (RedBlackNode *q = head->next; q != tail; q = q->next) q->data().~value_type();
 			}
-			if (t == NULL) return this->end();
-			else return iterator(*this, t);
+			p.release();
+			p.resource()->deallocate(head, sizeof(RedBlackNode), alignof(RedBlackNode));
+			p.resource()->deallocate(tail, sizeof(RedBlackNode), alignof(RedBlackNode));
 		}
-		const_iterator find(const Key &key) const {
-			RedBlackNode *t = root;
-			while (t != NULL && (compare(t->data->first, key) || compare(key, t->data->first))) {
-				if (compare(key, t->data->first)) t = t->left;
-				else t = t->right;
+		//drop this map's hold on its nodes, the last holder of a shared tree frees it
+		void release() {
+			if (sh == NULL) destroy(head, tail, pool);
+			else if (sh != &hollow().tree && --sh->refs == 0) {
+				destroy(head, tail, sh->pool);
+				deleteShared(sh);
 			}
-			if (t == NULL) return this->cend();
-			else return const_iterator(*this, t);
+			sh = NULL;
 		}
-
-	private:
-		void copyNode(RedBlackNode *newp, RedBlackNode *oldp) {
-			if (oldp->left != NULL) {
-				newp->left = new RedBlackNode;
-				copyNode(newp->left, oldp->left);
-			}
-			newp->data = new value_type(*(oldp->data));
-			newp->colour = oldp->colour;
-			newp->prev = tail->prev;
-			newp->next = tail;
-			tail->prev->next = newp;
-			tail->prev = newp;
-			if (oldp->right != NULL) {
-				newp->right = new RedBlackNode;
-				copyNode(newp->right, oldp->right);
+		//called before every change: a tree shared with other maps is copied first,
+		//nodes passed in are moved to their copies
+		void detach(RedBlackNode * &a, RedBlackNode * &b) {
+			if (sh == NULL || sh->refs == 1) return;
+			sharedTree *oldSh = sh;
+			RedBlackNode *oldRoot = root, *oldHead = head, *oldTail = tail;
+			if (oldSh == &hollow().tree) {
+				init(false);
+				if (a == oldTail) a = tail;
+				if (b == oldTail) b = tail;
+				return;
+			}
+			size_t n = siz;
+			init(true);
+			try { copyTree(oldRoot, n, &a, &b); }
+			catch (...) {
+				destroy(head, tail, sh->pool);
+				deleteShared(sh);
+				sh = oldSh;
+				root = oldRoot;
+				head = oldHead;
+				tail = oldTail;
+				siz = n;
+				throw;
 			}
+			if (a == oldTail) a = tail;
+			if (b == oldTail) b = tail;
+			if (--oldSh->refs == 0) {
+				destroy(oldHead, oldTail, oldSh->pool);
+				deleteShared(oldSh);
+			}
+		}
+		//what a moved-from map holds: nothing of its own
+		void makeHollow() noexcept {
+			hollowTree &h = hollow();
+			root = NULL;
+			head = &h.head;
+			tail = &h.tail;
+			siz = 0;
+			sh = &h.tree;
+		}
+		void detach(RedBlackNode * &a) {
+			RedBlackNode *b = NULL;
+			detach(a, b);
+		}
+		void detach() {
+			RedBlackNode *a = NULL, *b = NULL;
+			detach(a, b);
 		}
 		void makeEmpty(RedBlackNode * &t) {
 			if (t != NULL) {
 				makeEmpty(t->left);
 				makeEmpty(t->right);
-				delete t;
+				deleteNode(t);
 			}
 			t = NULL;
 		}
-		void LL(RedBlackNode * &t) {
+		static size_t sizeOf(RedBlackNode *t) { return t == NULL ? 0 : t->size; }
+		//the node with k nodes before it, k < siz
+		RedBlackNode *select(size_t k) const {
+			RedBlackNode *t = root;
+			for (;;) {
+				size_t l = sizeOf(t->left);
+				if (k < l) t = t->left;
+				else if (k == l) return t;
+				else { k -= l + 1; t = t->right; }
+			}
+		}
+		//the number of nodes before t, siz for tail
+		size_t indexOf(RedBlackNode *t) const {
+			if (t == tail) return siz;
+			size_t k = sizeOf(t->left);
+			for (; t->parent != NULL; t = t->parent)
+				if (t->parent->right == t) k += sizeOf(t->parent->left) + 1;
+			return k;
+		}
+		RedBlackNode *jump(RedBlackNode *t, ptrdiff_t n) const {
+			ptrdiff_t k = (ptrdiff_t)indexOf(t) + n;
+			if (k < 0 || k > (ptrdiff_t)siz) throw invalid_iterator();
+			return (size_t)k == siz ? tail : select(k);
+		}
+		static void reLink(RedBlackNode *oldp, RedBlackNode *newp, RedBlackNode * &root) {//newpȡoldp丸еλ
+			if (oldp->parent == NULL) root = newp;
+			else if (oldp->parent->left == oldp) oldp->parent->left = newp;
+			else oldp->parent->right = newp;
+			if (newp != NULL) newp->parent = oldp->parent;
+		}
+		//rotations and the insert fix-up also work on detached subtrees, root is the one they belong to
+		static void LL(RedBlackNode *t, RedBlackNode * &root) {
 			RedBlackNode *t1 = t->left;
 			t->left = t1->right;
+			if (t1->right != NULL) t1->right->parent = t;
+			reLink(t, t1, root);
 			t1->right = t;
-			t = t1;
+			t->parent = t1;
+			t1->size = t->size;
+			t->size = sizeOf(t->left) + sizeOf(t->right) + 1;
 		}
-		void RR(RedBlackNode * &t) {
+		static void RR(RedBlackNode *t, RedBlackNode * &root) {
 			RedBlackNode *t1 = t->right;
 			t->right = t1->left;
+			if (t1->left != NULL) t1->left->parent = t;
+			reLink(t, t1, root);
 			t1->left = t;
-			t = t1;
-		}
-		void LR(RedBlackNode * &t) {
-			RR(t->left);
-			LL(t);
+			t->parent = t1;
+			t1->size = t->size;
+			t->size = sizeOf(t->left) + sizeOf(t->right) + 1;
 		}
-		void RL(RedBlackNode * &t) {
-			LL(t->right);
-			RR(t);
+		static void LR(RedBlackNode *t, RedBlackNode * &root) {
+			RR(t->left, root);
+			LL(t, root);
 		}
-		void reLink(RedBlackNode *oldp, RedBlackNode *newp, linkStack &path){//path·
-			if (path.isEmpty()) root = newp;//·Ϊգ½
-			else {
-				RedBlackNode *grandParent = path.pop();//½ĸ
-				if (grandParent->left == oldp) grandParent->left = newp;
-				else grandParent->right = newp;
-				path.push(grandParent);
-			}
+		static void RL(RedBlackNode *t, RedBlackNode * &root) {
+			LL(t->right, root);
+			RR(t, root);
 		}
-		void insertReBalance(RedBlackNode *t, linkStack &path) {
-			RedBlackNode *parent, *grandParent, *uncle, *rootOfSubTree;
-			parent = path.pop();
-			while (parent->colour == 0) {//ǺɫʱҪ
-				if (parent == root) { parent->colour = 1; return; }//Ǹ
-
-				grandParent = rootOfSubTree = path.pop();
-				if (compare(parent->data->first,grandParent->data->first)) uncle = grandParent->right;
+		//true when the fix-up reached the root, which then adds a black level
+		static bool insertReBalance(RedBlackNode *t, RedBlackNode * &root) {
+			RedBlackNode *parent, *grandParent, *uncle;
+			parent = t->parent;
+			while (parent != NULL && parent->colour == 0) {//ǺɫʱҪ
+				grandParent = parent->parent;//ɫĸ㲻Ǹ
+				if (grandParent->left == parent) uncle = grandParent->right;
 				else uncle = grandParent->left;//ҳ
 
 				if (uncle == NULL || uncle->colour == 1) {//һ
@@ -505,106 +1418,141 @@ namespace sjtu {
 						if (t == parent->left) {            //LLb
 							parent->colour = 1;
 							grandParent->colour = 0;
-							LL(grandParent);
+							LL(grandParent, root);
 						}
 						else {                              //LRb
 							grandParent->colour = 0;
 							t->colour = 1;
-							LR(grandParent);
+							LR(grandParent, root);
 						}
 					}
 					else{
 					    if (t == parent->right) {           //RRb
 						    parent->colour = 1;
 						    grandParent->colour = 0;
-						    RR(grandParent);
+						    RR(grandParent, root);
 					    }
 					    else {                              //RLb
 					    	grandParent->colour = 0;
 					    	t->colour = 1;
-					    	RL(grandParent);
+					    	RL(grandParent, root);
 					    }
 					}
-					reLink(rootOfSubTree, grandParent, path);
-					return;
+					return false;
 				}
 				else {                                      //
 					grandParent->colour = 0;
 					parent->colour = 1;
 					uncle->colour = 1;
-					if (root == grandParent) { root->colour = 1; return; }
 					t = grandParent;
-					parent = path.pop();
+					parent = t->parent;
 				}
 			}
+			bool grew = (root->colour == 0);
+			root->colour = 1;
+			return grew;
 		}
-		void removeReBalance(RedBlackNode *t, linkStack &path)
-		{
-			RedBlackNode *parent, *sibling = NULL, *rootOfSubTree;
-			parent = rootOfSubTree = path.pop();
-
-			while (parent != NULL){
-				if (parent->left == t)  sibling = parent->right;
-				else  sibling = parent->left;
-
-				if (sibling->colour == 0)	{    //
-					sibling->colour = 1;
-					parent->colour = 0;
-					if (parent->left == t) RR(parent);
-					else LL(parent);
-					reLink(rootOfSubTree, parent, path);
-					path.push(parent);
-					parent = rootOfSubTree;
+		void eraseNode(RedBlackNode *t) {
+			unlinkNode(t);
+			deleteNode(t);
+		}
+		//unlink t from the tree and the thread, then rebalance upward from where it was
+		void unlinkNode(RedBlackNode *t) {
+			RedBlackNode *child, *parent;
+			int removedColour = t->colour;
+			RedBlackNode *from = (t->left == NULL || t->right == NULL) ? t->parent : t->next->parent;
+			for (; from != NULL; from = from->parent) from->size--;
+			if (t->left == NULL || t->right == NULL) {//ɾҶֻһӵĽ
+				child = (t->left ? t->left : t->right);
+				parent = t->parent;
+				reLink(t, child, root);
+			}
+			else {//ú̽ɾ
+				RedBlackNode *old = t->next;
+				removedColour = old->colour;
+				child = old->right;
+				if (old->parent == t) parent = old;
+				else {
+					parent = old->parent;
+					reLink(old, child, root);
+					old->right = t->right;
+					old->right->parent = old;
 				}
-				else{ //ֵǺڽ
-					if ((sibling->left == NULL || sibling->left->colour == 1) && (sibling->right == NULL || sibling->right->colour == 1)){
-						//L0R0
+				reLink(t, old, root);
+				old->left = t->left;
+				old->left->parent = old;
+				old->colour = t->colour;
+				old->size = t->size;
+			}
+			t->prev->next = t->next;
+			t->next->prev = t->prev;
+			siz--;
+			if (removedColour == 1) removeReBalance(child, parent);
+		}
+		void removeReBalance(RedBlackNode *t, RedBlackNode *parent) {//tһڽ㣬tΪ
+			RedBlackNode *sibling;
+			while (t != root && (t == NULL || t->colour == 1)) {
+				if (parent->left == t) {
+					sibling = parent->right;
+					if (sibling->colour == 0) {    //ֵǺ
+						sibling->colour = 1;
+						parent->colour = 0;
+						RR(parent, root);
+						sibling = parent->right;
+					}
+					if ((sibling->left == NULL || sibling->left->colour == 1) && (sibling->right == NULL || sibling->right->colour == 1)) {
 						sibling->colour = 0;
-						if (parent->colour == 0) { parent->colour = 1; return; }
-						else{             
-							t = parent;
-							if (t == root) return;
-							else parent = rootOfSubTree = path.pop();
+						t = parent;
+						parent = t->parent;
+					}
+					else {
+						if (sibling->right == NULL || sibling->right->colour == 1) {
+							sibling->left->colour = 1;
+							sibling->colour = 0;
+							LL(sibling, root);
+							sibling = parent->right;
 						}
+						sibling->colour = parent->colour;
+						parent->colour = 1;
+						sibling->right->colour = 1;
+						RR(parent, root);
+						t = root;
 					}
-					else break;
-				}
-
-			}//end of while
-
-			if (parent->left == t){//ֵҶ
-				if (sibling->left != NULL && sibling->left->colour == 0){
-					sibling->left->colour = parent->colour;
-					parent->colour = 1;
-					RL(parent);
-					reLink(rootOfSubTree, parent, path);
-				}
-				else{
-					sibling->colour = parent->colour;
-					sibling->right->colour = 1;
-					parent->colour = 1;
-					RR(parent);
-					reLink(rootOfSubTree, parent, path);
-				}
-			}
-			else{                    //ֵ
-				if (sibling->right != NULL && sibling->right->colour == 0){
-					sibling->right->colour = parent->colour;
-					parent->colour = 1;
-					LR(parent);
-					reLink(rootOfSubTree, parent, path);
 				}
-				else{
-					sibling->colour = parent->colour;
-					sibling->left->colour = 1;
-					parent->colour = 1;
-					LL(parent);
-					reLink(rootOfSubTree, parent, path);
+				else {
+					sibling = parent->left;
+					if (sibling->colour == 0) {
+						sibling->colour = 1;
+						parent->colour = 0;
+						LL(parent, root);
+						sibling = parent->left;
+					}
+					if ((sibling->left == NULL || sibling->left->colour == 1) && (sibling->right == NULL || sibling->right->colour == 1)) {
+						sibling->colour = 0;
+						t = parent;
+						parent = t->parent;
+					}
+					else {
+						if (sibling->left == NULL || sibling->left->colour == 1) {
+							sibling->right->colour = 1;
+							sibling->colour = 0;
+							RR(sibling, root);
+							sibling = parent->left;
+						}
+						sibling->colour = parent->colour;
+						parent->colour = 1;
+						sibling->left->colour = 1;
+						LL(parent, root);
+						t = root;
+					}
 				}
-
 			}
+			if (t != NULL) t->colour = 1;
 		}
 	};
 
+	template<class Key, class T, class Compare>
+	void swap(map<Key, T, Compare> &a, map<Key, T, Compare> &b) noexcept { a.swap(b); }
+
 }
 #endif
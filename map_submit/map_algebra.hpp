@@ -0,0 +1,328 @@
+/**
+* union, intersection and difference of two sjtu::maps, done by splitting and joining trees
+* on several threads. kept apart from map.hpp so the container itself needs no threads
+*/
+#ifndef SJTU_MAP_ALGEBRA_HPP
+#define SJTU_MAP_ALGEBRA_HPP
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <utility>
+#include "map.hpp"
+
+namespace sjtu {
+
+	//collision policies of map_union and map_intersection: resolve(kept, other) is called
+	//with a's and b's values of a key found in both, and leaves the result in kept
+	struct keep_first {
+		template<class T> void operator()(T &, T &) const {}
+	};
+	struct keep_second {
+		template<class T> void operator()(T &kept, T &other) const { kept = std::move(other); }
+	};
+
+	//join-based union, intersection and difference: one tree is split at the other's root, both sides
+	//are solved apart and joined again around the root, the larger tree giving the root. the two sides
+	//run on separate threads while the thread budget lasts. they only relink nodes, nodes that leave
+	//the result are gathered and freed once all threads are done. on an exception every level gives
+	//the nodes it holds to that list too, so all of them are destroyed
+	template<class Map>
+	struct setAlgebra {
+		typedef typename Map::RedBlackNode node;
+		enum op { unionOp, intersectionOp, differenceOp };
+		//smaller inputs are not worth a thread
+		static const size_t grain = 1 << 12;
+		//inputs closer in size than this are merged along their threads instead
+		static const size_t mergeRatio = 8;
+
+		//a detached subtree of black height bh, threaded between its own nodes
+		struct piece {
+			node *root;
+			int bh;
+			piece(node *r = NULL, int h = 0) :root(r), bh(h) {}
+		};
+		//nodes chained through next, from first to last
+		struct dropList {
+			node *first;
+			node *last;
+			dropList() :first(NULL), last(NULL) {}
+			void add(node *a, node *b) {
+				if (first == NULL) first = a;
+				else last->next = a;
+				last = b;
+			}
+			void add(const dropList &other) {
+				if (other.first != NULL) add(other.first, other.last);
+			}
+		};
+
+		template<class Resolve>
+		static Map apply(op o, Map &a, Map &b, Resolve &resolve, unsigned threads) {
+			Map res(a.get_memory_resource());
+			if (&a == &b) {
+				if (o == differenceOp) a.clear();
+				else res.join(a);
+				return res;
+			}
+			a.detach();
+			b.detach();
+			res.nodes().adopt(a.nodes());
+			res.nodes().adopt(b.nodes());
+			if (threads == 0) threads = std::thread::hardware_concurrency();
+			if (threads == 0) threads = 1;
+			dropList d;
+			piece r;
+			try { r = run(a, o, take(a), take(b), resolve, threads, d); }
+			catch (...) {
+				freeAll(res, d);
+				throw;
+			}
+			if (r.root != NULL) {
+				node *first = leftmost(r.root), *last = rightmost(r.root);
+				r.root->parent = NULL;
+				r.root->colour = 1;
+				res.root = r.root;
+				res.siz = r.root->size;
+				res.head->next = first;
+				first->prev = res.head;
+				last->next = res.tail;
+				res.tail->prev = last;
+			}
+			freeAll(res, d);
+			return res;
+		}
+
+		//m only lends its comparison. every node of a and b ends up in the result or in d,
+		//also when an exception leaves
+		template<class Resolve>
+		static piece run(const Map &m, op o, piece a, piece b, Resolve &resolve, unsigned threads, dropList &d) {
+			if (a.root == NULL || b.root == NULL) {
+				if (o == unionOp) return a.root == NULL ? b : a;
+				if (o == differenceOp && b.root == NULL) return a;
+				drop(a.root == NULL ? b : a, d);
+				return piece();
+			}
+			size_t sa = Map::sizeOf(a.root), sb = Map::sizeOf(b.root);
+			if ((threads == 1 || sa + sb < grain) && sa <= mergeRatio * sb && sb <= mergeRatio * sa)
+				return mergeLists(m, o, a, b, resolve, d);
+			bool pivotA = sa >= sb;
+			piece pv = pivotA ? a : b, other = pivotA ? b : a, lo, hi;
+			node *k = pv.root, *found;
+			int h = pv.bh - k->colour;
+			try { m.splitTree(other.root, other.bh, k->data().first, lo.root, lo.bh, hi.root, hi.bh, &found); }
+			catch (...) {
+				drop(a, d);
+				drop(b, d);
+				throw;
+			}
+			piece al = pivotA ? piece(k->left, h) : lo, bl = pivotA ? lo : piece(k->left, h);
+			piece ar = pivotA ? piece(k->right, h) : hi, br = pivotA ? hi : piece(k->right, h);
+			piece left, right;
+			dropList dl, dr;
+			size_t sl = Map::sizeOf(al.root) + Map::sizeOf(bl.root), sr = Map::sizeOf(ar.root) + Map::sizeOf(br.root);
+			unsigned tl = 0;
+			bool leftRan = false, rightRan = false;
+			std::thread worker;
+			std::exception_ptr workerError;
+			node *ka = pivotA ? k : found, *kb = pivotA ? found : k, *mid = NULL;
+			try {
+				if (threads > 1 && sl + sr >= grain) {
+					tl = (unsigned)((double)threads * sl / (sl + sr) + 0.5);
+					if (tl < 1) tl = 1;
+					if (tl > threads - 1) tl = threads - 1;
+					leftRan = true;
+					try {
+						worker = std::thread([&]() {
+							try { left = run(m, o, al, bl, resolve, tl, dl); }
+							catch (...) { workerError = std::current_exception(); }
+						});
+					}
+					catch (...) { tl = 0; }//no thread to be had, go on alone
+				}
+				if (tl == 0) {
+					leftRan = true;
+					left = run(m, o, al, bl, resolve, threads, dl);
+				}
+				rightRan = true;
+				right = run(m, o, ar, br, resolve, threads - tl, dr);
+				if (tl != 0) {
+					worker.join();
+					if (workerError) std::rethrow_exception(workerError);
+				}
+				if (found != NULL && o != differenceOp) resolve(ka->data().second, kb->data().second);
+			}
+			catch (...) {
+				//the worker must be done before its side is gathered; a side that threw has put its nodes in dl or dr
+				if (worker.joinable()) worker.join();
+				if (!leftRan) {
+					drop(al, dl);
+					drop(bl, dl);
+				}
+				if (!rightRan) {
+					drop(ar, dr);
+					drop(br, dr);
+				}
+				drop(left, d);
+				drop(right, d);
+				d.add(dl);
+				d.add(dr);
+				d.add(k, k);
+				if (found != NULL) d.add(found, found);
+				throw;
+			}
+			d.add(dl);
+			d.add(dr);
+			if (found != NULL) {
+				if (o == differenceOp) {
+					d.add(ka, ka);
+					d.add(kb, kb);
+				}
+				else {
+					d.add(kb, kb);
+					mid = ka;
+				}
+			}
+			else if (o == unionOp || (o == differenceOp && pivotA)) mid = k;
+			else d.add(k, k);
+			return mid != NULL ? join(left, mid, right) : join(left, right);
+		}
+
+		//walk both threads in step and build a balanced tree from what is kept, O(sa + sb)
+		template<class Resolve>
+		static piece mergeLists(const Map &m, op o, piece a, piece b, Resolve &resolve, dropList &d) {
+			node *pa = leftmost(a.root), *ea = rightmost(a.root), *pb = leftmost(b.root), *eb = rightmost(b.root);
+			size_t restA = a.root->size, restB = b.root->size, n = 0;
+			node *list = NULL, **end = &list, *kept = NULL, *p;
+			//a throw comes from a comparison or resolve before the nodes at hand move
+			try {
+				while (pa != NULL && pb != NULL) {
+					if (m.compare(pa->data().first, pb->data().first)) {
+						p = pa;
+						pa = (pa == ea ? NULL : pa->next);
+						restA--;
+						if (o == intersectionOp) d.add(p, p);
+						else { *end = kept = p; end = &p->next; n++; }
+					}
+					else if (m.compare(pb->data().first, pa->data().first)) {
+						p = pb;
+						pb = (pb == eb ? NULL : pb->next);
+						restB--;
+						if (o == unionOp) { *end = kept = p; end = &p->next; n++; }
+						else d.add(p, p);
+					}
+					else {
+						if (o != differenceOp) resolve(pa->data().second, pb->data().second);
+						p = pa;
+						node *q = pb;
+						pa = (pa == ea ? NULL : pa->next);
+						pb = (pb == eb ? NULL : pb->next);
+						restA--;
+						restB--;
+						if (o == differenceOp) d.add(p, p);
+						else { *end = kept = p; end = &p->next; n++; }
+						d.add(q, q);
+					}
+				}
+			}
+			catch (...) {
+				if (kept != NULL) d.add(list, kept);
+				if (pa != NULL) d.add(pa, ea);
+				if (pb != NULL) d.add(pb, eb);
+				throw;
+			}
+			if (pa != NULL) {
+				if (o == intersectionOp) d.add(pa, ea);
+				else { *end = pa; n += restA; }
+			}
+			if (pb != NULL) {
+				if (o == unionOp) { *end = pb; n += restB; }
+				else d.add(pb, eb);
+			}
+			if (n == 0) return piece();
+			int redDepth = 0;
+			for (size_t k = n; k > 1; k >>= 1) redDepth++;
+			node *rest = list, *prev = NULL;
+			piece res(Map::buildTree(rest, n, 0, redDepth), redDepth > 1 ? redDepth : 1);
+			res.root->parent = NULL;
+			for (p = list; n > 0; p = p->next, n--) {
+				p->prev = prev;
+				prev = p;
+			}
+			return res;
+		}
+		static piece take(Map &m) {
+			piece p(m.root, Map::blackHeight(m.root));
+			m.root = NULL;
+			m.siz = 0;
+			m.head->next = m.tail;
+			m.tail->prev = m.head;
+			return p;
+		}
+		static node *leftmost(node *t) {
+			while (t->left != NULL) t = t->left;
+			return t;
+		}
+		static node *rightmost(node *t) {
+			while (t->right != NULL) t = t->right;
+			return t;
+		}
+		static void drop(piece p, dropList &d) {
+			if (p.root != NULL) d.add(leftmost(p.root), rightmost(p.root));
+		}
+		static piece join(piece l, node *k, piece r) {
+			if (l.root != NULL) {
+				node *p = rightmost(l.root);
+				p->next = k;
+				k->prev = p;
+			}
+			if (r.root != NULL) {
+				node *p = leftmost(r.root);
+				k->next = p;
+				p->prev = k;
+			}
+			piece res;
+			res.root = Map::joinTree(l.root, l.bh, k, r.root, r.bh, res.bh);
+			return res;
+		}
+		//join without a middle node: r's first node is split off to take that place
+		static piece join(piece l, piece r) {
+			if (l.root == NULL) return r;
+			if (r.root == NULL) return l;
+			node *k;
+			piece rest;
+			Map::splitFirst(r.root, r.bh, k, rest.root, rest.bh);
+			return join(l, k, rest);
+		}
+		static void freeAll(Map &res, const dropList &d) {
+			for (node *p = d.first, *next; p != NULL; p = next) {
+				next = (p == d.last ? NULL : p->next);
+				res.deleteNode(p);
+			}
+		}
+	};
+
+	//the keys of a and b; a key found in both keeps a's node and calls resolve(a's value, b's value).
+	//all nodes move to the result and a and b are left empty. O(m log(n / m + 1)) work for sizes m <= n,
+	//shared by up to threads threads (0 for one per core), so resolve must be safe to call from them.
+	//an exception from resolve or the comparison reaches the caller once every thread is done;
+	//a and b are then left empty and every element of both is destroyed
+	template<class Key, class T, class Compare, class Resolve = keep_first>
+	map<Key, T, Compare> map_union(map<Key, T, Compare> &a, map<Key, T, Compare> &b, Resolve resolve = Resolve(), unsigned threads = 0) {
+		return setAlgebra<map<Key, T, Compare>>::apply(setAlgebra<map<Key, T, Compare>>::unionOp, a, b, resolve, threads);
+	}
+	//the keys found in both, resolved as in map_union
+	template<class Key, class T, class Compare, class Resolve = keep_first>
+	map<Key, T, Compare> map_intersection(map<Key, T, Compare> &a, map<Key, T, Compare> &b, Resolve resolve = Resolve(), unsigned threads = 0) {
+		return setAlgebra<map<Key, T, Compare>>::apply(setAlgebra<map<Key, T, Compare>>::intersectionOp, a, b, resolve, threads);
+	}
+	//the keys of a missing from b
+	template<class Key, class T, class Compare>
+	map<Key, T, Compare> map_difference(map<Key, T, Compare> &a, map<Key, T, Compare> &b, unsigned threads = 0) {
+		keep_first resolve;
+		return setAlgebra<map<Key, T, Compare>>::apply(setAlgebra<map<Key, T, Compare>>::differenceOp, a, b, resolve, threads);
+	}
+
+}
+
+#endif
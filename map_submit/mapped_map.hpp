@@ -0,0 +1,100 @@
+/**
+* a read-only map served straight from a file written by map::save() or
+* frozen_map::save(). the file is mapped into memory and used as it is:
+* opening it only checks the header, so it takes the same time for any
+* number of elements, and pages are read in as lookups touch them.
+* lookups and iteration are those of frozen_map
+*/
+#ifndef SJTU_MAPPED_MAP_HPP
+#define SJTU_MAPPED_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "frozen_map.hpp"
+
+namespace sjtu {
+
+	template< class Key, class T, class Compare = std::less<Key>>
+	class mapped_map {
+	public:
+		typedef pair<const Key, T> value_type;
+		typedef typename frozen_map<Key, T, Compare>::const_iterator const_iterator;
+		typedef const_iterator iterator;
+	private:
+		static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value,
+			"an image holds raw keys and values");
+
+		//the mapped file, unmapped after the view on it is gone
+		struct mapping {
+			void *base;
+			size_t length;
+			mapping(const char *path) {
+				int fd = open(path, O_RDONLY);
+				if (fd < 0) throw runtime_error();
+				struct stat st;
+				if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(mapImageHeader)) {
+					close(fd);
+					throw runtime_error();
+				}
+				length = st.st_size;
+				base = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+				close(fd);
+				if (base == MAP_FAILED) throw runtime_error();
+			}
+			~mapping() { munmap(base, length); }
+			char *at(uint64_t offset) const { return static_cast<char *>(base) + offset; }
+		};
+
+		mapping file;
+		mapImageHeader header;
+		frozen_map<Key, T, Compare> view;
+
+		//the header of a valid image, throws runtime_error if it does not fit this map
+		static mapImageHeader check(const mapping &m) {
+			mapImageHeader h;
+			memcpy(&h, m.base, sizeof(h));
+			bool ok = memcmp(h.magic, "sjtumap", 8) == 0 && h.byteOrder == 0x01020304
+				&& h.version == frozen_map<Key, T, Compare>::imageVersion
+				&& h.keySize == sizeof(Key) && h.valueSize == sizeof(T) && h.fileSize == m.length
+				&& h.n < h.fileSize && h.keysOffset % alignof(Key) == 0 && h.valuesOffset % alignof(T) == 0
+				//the offsets are bounded first, so the sizes below are differences that cannot wrap
+				&& sizeof(h) <= h.keysOffset && h.keysOffset <= h.valuesOffset && h.valuesOffset <= h.fileSize
+				&& (h.valuesOffset - h.keysOffset) / sizeof(Key) > h.n
+				&& (h.fileSize - h.valuesOffset) % sizeof(T) == 0 && (h.fileSize - h.valuesOffset) / sizeof(T) == h.n + 1;
+			if (!ok) throw runtime_error();
+			return h;
+		}
+
+	public:
+		//throws runtime_error if path cannot be mapped or does not hold an image of this map
+		explicit mapped_map(const char *path) :file(path), header(check(file)),
+			view(reinterpret_cast<Key *>(file.at(header.keysOffset)), reinterpret_cast<T *>(file.at(header.valuesOffset)), header.n) {}
+		mapped_map(const mapped_map &) = delete;
+		mapped_map & operator=(const mapped_map &) = delete;
+
+		const T & at(const Key &key) const { return view.at(key); }
+		const T & operator[](const Key &key) const { return view.at(key); }
+		size_t count(const Key &key) const { return view.count(key); }
+		const_iterator find(const Key &key) const { return view.find(key); }
+		const_iterator lower_bound(const Key &key) const { return view.lower_bound(key); }
+		const_iterator upper_bound(const Key &key) const { return view.upper_bound(key); }
+		const_iterator cbegin() const { return view.cbegin(); }
+		const_iterator cend() const { return view.cend(); }
+		const_iterator begin() const { return view.cbegin(); }
+		const_iterator end() const { return view.cend(); }
+		bool empty() const { return view.empty(); }
+		size_t size() const { return view.size(); }
+	};
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+/**
+* where a map gets its memory from, after std::pmr::memory_resource.
+* new_delete_resource() is the global operator new; monotonic_buffer_resource
+* is an arena that hands out pieces of large chunks, ignores deallocate and
+* gives everything back at once in release(), so all the maps of one tenant
+* can live in one arena that is dropped in a few calls and reports what they use
+*/
+#ifndef SJTU_MEMORY_RESOURCE_HPP
+#define SJTU_MEMORY_RESOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
+
+namespace sjtu {
+
+	class memory_resource {
+	public:
+		virtual ~memory_resource() {}
+		void *allocate(size_t bytes, size_t align = alignof(std::max_align_t)) { return do_allocate(bytes, align); }
+		void deallocate(void *p, size_t bytes, size_t align = alignof(std::max_align_t)) { do_deallocate(p, bytes, align); }
+		//memory from one can be given back to the other
+		bool is_equal(const memory_resource &other) const noexcept { return this == &other || do_is_equal(other); }
+	private:
+		virtual void *do_allocate(size_t bytes, size_t align) = 0;
+		virtual void do_deallocate(void *p, size_t bytes, size_t align) = 0;
+		virtual bool do_is_equal(const memory_resource &other) const noexcept { return this == &other; }
+	};
+
+	//blocks aligned beyond what plain new gives use aligned new where the language has it;
+	//before C++17 they are cut from a larger block that keeps its start just in front of them
+	class newDeleteResource : public memory_resource {
+#ifdef __STDCPP_DEFAULT_NEW_ALIGNMENT__
+		static const size_t newAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+		static const size_t newAlign = alignof(std::max_align_t);
+#endif
+		void *do_allocate(size_t bytes, size_t align) override {
+			if (align <= newAlign) return ::operator new(bytes);
+#ifdef __cpp_aligned_new
+			return ::operator new(bytes, std::align_val_t(align));
+#else
+			char *raw = static_cast<char *>(::operator new(bytes + align + sizeof(void *)));
+			char *p = raw + sizeof(void *);
+			p += (size_t)(-(uintptr_t)p) & (align - 1);
+			reinterpret_cast<void **>(p)[-1] = raw;
+			return p;
+#endif
+		}
+		void do_deallocate(void *p, size_t, size_t align) override {
+			if (align <= newAlign) ::operator delete(p);
+#ifdef __cpp_aligned_new
+			else ::operator delete(p, std::align_val_t(align));
+#else
+			else ::operator delete(static_cast<void **>(p)[-1]);
+#endif
+		}
+	};
+	inline memory_resource *new_delete_resource() noexcept {
+		static newDeleteResource r;
+		return &r;
+	}
+
+	inline std::atomic<memory_resource *> &defaultResource() {
+		static std::atomic<memory_resource *> r(new_delete_resource());
+		return r;
+	}
+	//what maps built without a resource use, new_delete_resource() unless set
+	inline memory_resource *get_default_resource() noexcept { return defaultResource().load(); }
+	//NULL restores new_delete_resource(); returns the one before
+	inline memory_resource *set_default_resource(memory_resource *r) noexcept {
+		return defaultResource().exchange(r != NULL ? r : new_delete_resource());
+	}
+
+	//not thread safe: maps sharing an arena must not allocate from different threads at once.
+	//the arena must outlive every map allocated from it, a map destroyed later frees into released chunks
+	class monotonic_buffer_resource : public memory_resource {
+	public:
+		//chunks start at initialSize bytes and double, up to maxChunk
+		explicit monotonic_buffer_resource(size_t initialSize = 4096, memory_resource *upstream = get_default_resource())
+			:up(upstream), chunks(NULL), cur(NULL), left(0), nextSize(initialSize < minChunk ? minChunk : initialSize), used(0), held(0) {}
+		explicit monotonic_buffer_resource(memory_resource *upstream) :monotonic_buffer_resource(4096, upstream) {}
+		monotonic_buffer_resource(const monotonic_buffer_resource &) = delete;
+		monotonic_buffer_resource & operator=(const monotonic_buffer_resource &) = delete;
+		~monotonic_buffer_resource() { release(); }
+
+		//give every chunk back to upstream; whatever was allocated here must no longer be used
+		void release() {
+			while (chunks != NULL) {
+				chunk *c = chunks;
+				chunks = c->next;
+				up->deallocate(c, c->size, alignof(chunk));
+			}
+			cur = NULL;
+			left = 0;
+			used = held = 0;
+		}
+		memory_resource *upstream_resource() const { return up; }
+		//bytes handed out since the last release()
+		size_t bytes_allocated() const { return used; }
+		//bytes taken from upstream
+		size_t bytes_reserved() const { return held; }
+
+	private:
+		struct chunk {
+			chunk *next;
+			size_t size;
+		};
+		static const size_t minChunk = 256;
+		static const size_t maxChunk = size_t(1) << 26;
+
+		memory_resource *up;
+		chunk *chunks;
+		char *cur;
+		size_t left;
+		size_t nextSize;
+		size_t used;
+		size_t held;
+
+		void *do_allocate(size_t bytes, size_t align) override {
+			size_t pad = (size_t)(-(uintptr_t)cur) & (align - 1);
+			if (cur == NULL || pad + bytes > left) {
+				newChunk(bytes + align);
+				pad = (size_t)(-(uintptr_t)cur) & (align - 1);
+			}
+			void *p = cur + pad;
+			cur += pad + bytes;
+			left -= pad + bytes;
+			used += bytes;
+			return p;
+		}
+		void do_deallocate(void *, size_t, size_t) override {}
+
+		void newChunk(size_t need) {
+			size_t size = nextSize;
+			if (size < need + sizeof(chunk)) size = need + sizeof(chunk);
+			chunk *c = static_cast<chunk *>(up->allocate(size, alignof(chunk)));
+			c->next = chunks;
+			c->size = size;
+			chunks = c;
+			cur = reinterpret_cast<char *>(c + 1);
+			left = size - sizeof(chunk);
+			held += size;
+			if (nextSize < maxChunk) nextSize *= 2;
+		}
+	};
+
+}
+
+#endif
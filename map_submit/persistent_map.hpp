@@ -0,0 +1,331 @@
+/**
+* a persistent red-black tree with the lookup interface of sjtu::map
+* insert and erase leave the map untouched and return a new version that
+* shares every node off the changed path, so a version costs O(log n)
+* time and memory and a copy of one costs O(1).
+* nodes are reference counted and can be shared between threads;
+* rebalancing follows Okasaki (insert) and Kahrs (erase)
+*/
+#ifndef SJTU_PERSISTENT_MAP_HPP
+#define SJTU_PERSISTENT_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <atomic>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+	template< class Key, class T, class Compare = std::less<Key>>
+	class persistent_map {
+	public:
+		typedef pair<const Key, T> value_type;
+	private:
+		struct node {
+			value_type value;
+			node *left;
+			node *right;
+			int colour; //0-red,1-black
+			std::atomic<size_t> refs;
+			node(const value_type &v, int c, node *l, node *r) :value(v), left(l), right(r), colour(c), refs(1) {}
+		};
+		//no red-black tree with size_t elements is deeper than this
+		static const int maxDepth = 2 * 8 * sizeof(size_t);
+
+		node *root;
+		size_t siz;
+		Compare compare;
+
+		persistent_map(node *r, size_t n) :root(r), siz(n) {}
+
+	public:
+		//keeps the path from the root, so no node needs a parent or thread pointer
+		class const_iterator {
+		public:
+			const node *path[maxDepth];
+			int depth; //0 at end()
+			const persistent_map<Key, T, Compare> *mPtr;
+			const_iterator() { depth = 0; mPtr = NULL; }
+			const_iterator(const persistent_map<Key, T, Compare> &m) { depth = 0; mPtr = &m; }
+			const_iterator(const const_iterator &other) { copy(other); }
+			const_iterator & operator=(const const_iterator &other) {
+				copy(other);
+				return *this;
+			}
+			const_iterator operator++(int) {
+				const_iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (depth == 0) throw invalid_iterator();
+				const node *t = path[depth - 1];
+				if (t->right != NULL) pushLeft(t->right);
+				else {//climb until we leave a left subtree
+					t = path[--depth];
+					while (depth > 0 && path[depth - 1]->right == t) t = path[--depth];
+				}
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				if (mPtr == NULL || mPtr->root == NULL) throw invalid_iterator();
+				if (depth == 0) { pushRight(mPtr->root); return *this; }
+				const node *t = path[depth - 1];
+				if (t->left != NULL) { pushRight(t->left); return *this; }
+				int d = depth - 1;
+				while (d > 0 && path[d - 1]->left == t) t = path[--d];
+				if (d == 0) throw invalid_iterator();//already at begin()
+				depth = d;
+				return *this;
+			}
+			bool operator==(const const_iterator &rhs) const {
+				return rhs.mPtr == mPtr && rhs.depth == depth && (depth == 0 || rhs.path[depth - 1] == path[depth - 1]);
+			}
+			bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+			const value_type & operator*() const {
+				if (depth == 0) throw invalid_iterator();
+				else return path[depth - 1]->value;
+			}
+			const value_type* operator->() const noexcept { return &(path[depth - 1]->value); }
+
+		private:
+			void copy(const const_iterator &other) {
+				depth = other.depth;
+				mPtr = other.mPtr;
+				for (int i = 0; i < depth; i++) path[i] = other.path[i];
+			}
+			void pushLeft(const node *t) {
+				for (; t != NULL; t = t->left) path[depth++] = t;
+			}
+			void pushRight(const node *t) {
+				for (; t != NULL; t = t->right) path[depth++] = t;
+			}
+			friend class persistent_map;
+		};
+		typedef const_iterator iterator;
+
+		persistent_map() :root(NULL), siz(0) {}
+		persistent_map(const persistent_map &other) :root(share(other.root)), siz(other.siz) {}
+		persistent_map & operator=(const persistent_map &other) {
+			node *old = root;
+			root = share(other.root);
+			siz = other.siz;
+			drop(old);
+			return *this;
+		}
+		~persistent_map() { drop(root); }
+
+		const T & at(const Key &key) const {
+			const node *t = findNode(key);
+			if (t == NULL) throw index_out_of_bound();
+			return t->value.second;
+		}
+		const T & operator[](const Key &key) const { return at(key); }
+		size_t count(const Key &key) const { return findNode(key) == NULL ? 0 : 1; }
+		const_iterator find(const Key &key) const {
+			const_iterator p(*this);
+			for (const node *t = root; t != NULL;) {
+				p.path[p.depth++] = t;
+				if (compare(key, t->value.first)) t = t->left;
+				else if (compare(t->value.first, key)) t = t->right;
+				else return p;
+			}
+			return cend();
+		}
+		const_iterator cbegin() const {
+			const_iterator p(*this);
+			p.pushLeft(root);
+			return p;
+		}
+		const_iterator cend() const { return const_iterator(*this); }
+		const_iterator begin() const { return cbegin(); }
+		const_iterator end() const { return cend(); }
+		bool empty() const { return siz == 0; }
+		size_t size() const { return siz; }
+
+		//a version with x added; this version is returned if x's key is present
+		persistent_map insert(const value_type &x) const {
+			if (findNode(x.first) != NULL) return *this;
+			return persistent_map(blacken(ins(root, x)), siz + 1);
+		}
+		//a version mapping key to obj, whether or not key is present
+		persistent_map insert_or_assign(const Key &key, const T &obj) const {
+			value_type x(key, obj);
+			bool found = findNode(key) != NULL;
+			return persistent_map(blacken(ins(root, x)), found ? siz : siz + 1);
+		}
+		//a version without key; this version is returned if key is missing
+		persistent_map erase(const Key &key) const {
+			if (findNode(key) == NULL) return *this;
+			node *r = del(root, key);
+			return persistent_map(r == NULL ? NULL : blacken(r), siz - 1);
+		}
+		persistent_map clear() const { return persistent_map(); }
+
+	private:
+		const node *findNode(const Key &key) const {
+			const node *t = root;
+			while (t != NULL) {
+				if (compare(key, t->value.first)) t = t->left;
+				else if (compare(t->value.first, key)) t = t->right;
+				else return t;
+			}
+			return NULL;
+		}
+
+		//every node * below is an owned reference unless it is a plain lookup
+		static node *share(node *t) {
+			if (t != NULL) t->refs.fetch_add(1, std::memory_order_relaxed);
+			return t;
+		}
+		static void drop(node *t) {
+			if (t != NULL && t->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				drop(t->left);
+				drop(t->right);
+				delete t;
+			}
+		}
+		static bool isRed(const node *t) { return t != NULL && t->colour == 0; }
+		static bool isBlack(const node *t) { return t != NULL && t->colour == 1; }
+		//owned references to t's children; a node nobody else holds gives them up
+		static void take(node *t, node * &l, node * &r) {
+			if (t->refs.load(std::memory_order_acquire) == 1) {
+				l = t->left;
+				r = t->right;
+				t->left = t->right = NULL;
+			}
+			else {
+				l = share(t->left);
+				r = share(t->right);
+			}
+		}
+		//t's value with new children and colour, reusing t when nobody else holds it
+		static node *make(int colour, node *l, node *t, node *r) {
+			if (t->refs.load(std::memory_order_acquire) == 1) {
+				t->colour = colour;
+				t->left = l;
+				t->right = r;
+				return t;
+			}
+			node *p = new node(t->value, colour, l, r);
+			drop(t);
+			return p;
+		}
+		static node *paint(node *t, int colour) {
+			if (t->colour == colour) return t;
+			node *l, *r;
+			take(t, l, r);
+			return make(colour, l, t, r);
+		}
+		static node *blacken(node *t) { return paint(t, 1); }
+		//a black node over l and r with at most one red-red pair below it
+		static node *balance(node *l, node *t, node *r) {
+			node *a, *b, *c, *d;
+			if (isRed(l) && isRed(r)) return make(0, paint(l, 1), t, paint(r, 1));
+			if (isRed(l) && isRed(l->left)) {
+				take(l, a, b);
+				return make(0, paint(a, 1), l, make(1, b, t, r));
+			}
+			if (isRed(l) && isRed(l->right)) {
+				take(l, a, b);
+				take(b, c, d);
+				return make(0, make(1, a, l, c), b, make(1, d, t, r));
+			}
+			if (isRed(r) && isRed(r->right)) {
+				take(r, a, b);
+				return make(0, make(1, l, t, a), r, paint(b, 1));
+			}
+			if (isRed(r) && isRed(r->left)) {
+				take(r, a, b);
+				take(a, c, d);
+				return make(0, make(1, l, t, c), a, make(1, d, r, b));
+			}
+			return make(1, l, t, r);
+		}
+		node *ins(node *t, const value_type &x) const {
+			if (t == NULL) return new node(x, 0, NULL, NULL);
+			if (compare(x.first, t->value.first)) {
+				node *l = ins(t->left, x);
+				if (t->colour == 1) return balance(l, share(t), share(t->right));
+				return make(0, l, share(t), share(t->right));
+			}
+			if (compare(t->value.first, x.first)) {
+				node *r = ins(t->right, x);
+				if (t->colour == 1) return balance(share(t->left), share(t), r);
+				return make(0, share(t->left), share(t), r);
+			}
+			return new node(x, t->colour, share(t->left), share(t->right));
+		}
+		//key must be present
+		node *del(node *t, const Key &key) const {
+			if (compare(key, t->value.first)) {
+				if (isBlack(t->left)) return balLeft(del(t->left, key), share(t), share(t->right));
+				return make(0, del(t->left, key), share(t), share(t->right));
+			}
+			if (compare(t->value.first, key)) {
+				if (isBlack(t->right)) return balRight(share(t->left), share(t), del(t->right, key));
+				return make(0, share(t->left), share(t), del(t->right, key));
+			}
+			return fuse(share(t->left), share(t->right));
+		}
+		//l lost one black level
+		static node *balLeft(node *l, node *t, node *r) {
+			if (isRed(l)) return make(0, paint(l, 1), t, r);
+			if (isBlack(r)) return balance(l, t, paint(r, 0));
+			node *a, *b, *c, *d;
+			take(r, a, b);//r is red over a black a
+			take(a, c, d);
+			return make(0, make(1, l, t, c), a, balance(d, r, paint(b, 0)));
+		}
+		//r lost one black level
+		static node *balRight(node *l, node *t, node *r) {
+			if (isRed(r)) return make(0, l, t, paint(r, 1));
+			if (isBlack(l)) return balance(paint(l, 0), t, r);
+			node *a, *b, *c, *d;
+			take(l, a, b);//l is red over a black b
+			take(b, c, d);
+			return make(0, balance(paint(a, 0), l, c), b, make(1, d, t, r));
+		}
+		//join two trees of equal black height whose keys are in order
+		static node *fuse(node *l, node *r) {
+			if (l == NULL) return r;
+			if (r == NULL) return l;
+			node *a, *b, *c, *d, *e, *f;
+			if (isRed(l) && isRed(r)) {
+				take(l, a, b);
+				take(r, c, d);
+				node *m = fuse(b, c);
+				if (isRed(m)) {
+					take(m, e, f);
+					return make(0, make(0, a, l, e), m, make(0, f, r, d));
+				}
+				return make(0, a, l, make(0, m, r, d));
+			}
+			if (isBlack(l) && isBlack(r)) {
+				take(l, a, b);
+				take(r, c, d);
+				node *m = fuse(b, c);
+				if (isRed(m)) {
+					take(m, e, f);
+					return make(0, make(1, a, l, e), m, make(1, f, r, d));
+				}
+				return balLeft(a, l, make(1, m, r, d));
+			}
+			if (isRed(r)) {
+				take(r, c, d);
+				return make(0, fuse(l, c), r, d);
+			}
+			take(l, a, b);
+			return make(0, a, l, fuse(b, r));
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,150 @@
+/**
+* the binary format of map::serialize and map::deserialize
+* a map is written as its element count and then each key followed by its
+* value, in key order. counts and lengths are varints (7 bits a byte, low
+* bits first), trivially copyable types are their raw bytes in host order,
+* std::string is its length and its characters.
+* other types plug in by specializing serial<X>:
+*	template<class Out> static void write(Out &out, const X &x);
+*	template<class In> static X read(In &in);
+* where out is a serialWriter and in a streamReader or bufferReader, with
+* out.put(p, n), out.putSize(n), in.get(p, n) and in.getSize()
+*/
+#ifndef SJTU_SERIAL_HPP
+#define SJTU_SERIAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+	template<class X, class Enable = void>
+	struct serial {
+		static_assert(std::is_trivially_copyable<X>::value, "specialize sjtu::serial for this type");
+	};
+
+	template<class X>
+	struct serial<X, typename std::enable_if<std::is_trivially_copyable<X>::value>::type> {
+		template<class Out> static void write(Out &out, const X &x) { out.put(&x, sizeof(X)); }
+		template<class In> static X read(In &in) {
+			typename std::aligned_storage<sizeof(X), alignof(X)>::type raw;
+			in.get(&raw, sizeof(X));
+			return *reinterpret_cast<X *>(&raw);
+		}
+	};
+
+	template<>
+	struct serial<std::string> {
+		template<class Out> static void write(Out &out, const std::string &s) {
+			out.putSize(s.size());
+			out.put(s.data(), s.size());
+		}
+		//read in pieces, so a corrupt length fails at the end of the input rather than in one huge allocation
+		template<class In> static std::string read(In &in) {
+			uint64_t n = in.getSize();
+			std::string s;
+			char piece[4096];
+			while (n > 0) {
+				size_t k = (n < sizeof(piece) ? n : sizeof(piece));
+				in.get(piece, k);
+				s.append(piece, k);
+				n -= k;
+			}
+			return s;
+		}
+	};
+
+	//gathers bytes in a buffer: the caller's, or its own that goes to a stream in large pieces
+	class serialWriter {
+	public:
+		serialWriter(std::ostream &os) :os(&os), buf(&own) {}
+		//appends to out
+		serialWriter(std::vector<char> &out) :os(NULL), buf(&out) {}
+		serialWriter(const serialWriter &) = delete;
+		serialWriter & operator=(const serialWriter &) = delete;
+		void put(const void *p, size_t n) {
+			const char *c = static_cast<const char *>(p);
+			buf->insert(buf->end(), c, c + n);
+			if (os != NULL && buf->size() >= flushSize) flush();
+		}
+		void putSize(uint64_t x) {
+			char bytes[10];
+			size_t n = 0;
+			for (; x >= 0x80; x >>= 7) bytes[n++] = char(x | 0x80);
+			bytes[n++] = char(x);
+			put(bytes, n);
+		}
+		//throws runtime_error if the stream fails
+		void finish() {
+			if (os != NULL) flush();
+		}
+	private:
+		static const size_t flushSize = 1 << 16;
+		void flush() {
+			if (!buf->empty() && !os->write(buf->data(), buf->size())) throw runtime_error();
+			buf->clear();
+		}
+		std::vector<char> own;
+		std::ostream *os;
+		std::vector<char> *buf;
+	};
+
+	//the readers throw runtime_error when the input ends early
+	class streamReader {
+	public:
+		streamReader(std::istream &is) :is(is) {}
+		void get(void *p, size_t n) {
+			if (n != 0 && is.rdbuf()->sgetn(static_cast<char *>(p), n) != (std::streamsize)n) {
+				is.setstate(std::ios::failbit);
+				throw runtime_error();
+			}
+		}
+		uint64_t getSize() {
+			uint64_t x = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				int c = is.rdbuf()->sbumpc();
+				if (c == std::char_traits<char>::eof()) {
+					is.setstate(std::ios::failbit);
+					throw runtime_error();
+				}
+				x |= uint64_t(c & 0x7f) << shift;
+				if ((c & 0x80) == 0) return x;
+			}
+			throw runtime_error();
+		}
+	private:
+		std::istream &is;
+	};
+	class bufferReader {
+	public:
+		bufferReader(const char *data, size_t len) :p(data), end(data + len) {}
+		void get(void *to, size_t n) {
+			if ((size_t)(end - p) < n) throw runtime_error();
+			memcpy(to, p, n);
+			p += n;
+		}
+		uint64_t getSize() {
+			uint64_t x = 0;
+			for (int shift = 0; shift < 64 && p < end; shift += 7) {
+				unsigned char c = *p++;
+				x |= uint64_t(c & 0x7f) << shift;
+				if ((c & 0x80) == 0) return x;
+			}
+			throw runtime_error();
+		}
+		const char *position() const { return p; }
+	private:
+		const char *p;
+		const char *end;
+	};
+
+}
+
+#endif
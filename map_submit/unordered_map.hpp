@@ -0,0 +1,366 @@
+/**
+* an open addressing hash map with the lookup interface of sjtu::map
+* collisions are resolved with Robin Hood probing: every slot keeps a
+* byte holding its distance from the home slot (0 for an empty slot),
+* lookups stop as soon as they meet a closer element, and erase shifts
+* the rest of the cluster back instead of leaving tombstones.
+* distances from maxDist up share one byte value and are worked out again
+* from the key's hash, so a poor hash makes the map slow but never fails.
+* insert and erase may move other elements, so they invalidate iterators
+*/
+#ifndef SJTU_UNORDERED_MAP_HPP
+#define SJTU_UNORDERED_MAP_HPP
+
+#include <functional>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+	template< class Key, class T, class Hash = std::hash<Key>, class Equal = std::equal_to<Key>>
+	class unordered_map {
+	public:
+		typedef pair<const Key, T> value_type;
+	private:
+		typedef typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type slot;
+		static const size_t minCap = 16;
+		static const unsigned char maxDist = 254; //this and more
+
+		slot *slots;
+		unsigned char *dist; //distance from the home slot plus one up to maxDist, 0 marks an empty slot
+		size_t cap;
+		int shift;
+		Hash hash;
+		Equal equal;
+		size_t siz;
+
+	public:
+		class const_iterator;
+		class iterator {
+		public:
+			size_t it;
+			unordered_map<Key, T, Hash, Equal> *mPtr;
+			iterator() { it = 0; mPtr = NULL; }
+			iterator(unordered_map<Key, T, Hash, Equal> &m, size_t p) { mPtr = &m; it = p; }
+			iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
+			iterator & operator=(const iterator &other) {
+				it = other.it;
+				mPtr = other.mPtr;
+				return *this;
+			}
+			iterator operator++(int) {
+				iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			iterator & operator++() {
+				if (it == mPtr->cap) throw invalid_iterator();
+				it = mPtr->nextSlot(it + 1);
+				return *this;
+			}
+			iterator operator--(int) {
+				iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			iterator & operator--() {
+				size_t p = mPtr->prevSlot(it);
+				if (p == mPtr->cap) throw invalid_iterator();
+				it = p;
+				return *this;
+			}
+			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			value_type & operator*() const {
+				if (it == mPtr->cap) throw invalid_iterator();
+				else return mPtr->data(it);
+			}
+			value_type* operator->() const noexcept { return &(mPtr->data(it)); }
+		};
+		class const_iterator {
+		public:
+			size_t it;
+			const unordered_map<Key, T, Hash, Equal> *mPtr;
+			const_iterator() { it = 0; mPtr = NULL; }
+			const_iterator(const unordered_map<Key, T, Hash, Equal> &m, size_t p) { mPtr = &m; it = p; }
+			const_iterator(const iterator &other) { it = other.it; mPtr = other.mPtr; }
+			const_iterator(const const_iterator &other) { it = other.it; mPtr = other.mPtr; }
+			const_iterator & operator=(const const_iterator &other) {
+				it = other.it;
+				mPtr = other.mPtr;
+				return *this;
+			}
+			const_iterator operator++(int) {
+				const_iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (it == mPtr->cap) throw invalid_iterator();
+				it = mPtr->nextSlot(it + 1);
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp(*this);
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				size_t p = mPtr->prevSlot(it);
+				if (p == mPtr->cap) throw invalid_iterator();
+				it = p;
+				return *this;
+			}
+			bool operator==(const iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator==(const const_iterator &rhs) const { return (rhs.mPtr == mPtr&&rhs.it == it); }
+			bool operator!=(const iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			bool operator!=(const const_iterator &rhs) const { return (rhs.mPtr != mPtr || rhs.it != it); }
+			value_type & operator*() const {
+				if (it == mPtr->cap) throw invalid_iterator();
+				else return mPtr->data(it);
+			}
+			value_type* operator->() const noexcept { return &(mPtr->data(it)); }
+		};
+		unordered_map() {
+			slots = NULL;
+			dist = NULL;
+			cap = 0;
+			shift = 64;
+			siz = 0;
+		}
+		unordered_map(const unordered_map &other) :hash(other.hash), equal(other.equal) {
+			slots = NULL;
+			dist = NULL;
+			cap = 0;
+			shift = 64;
+			siz = 0;
+			try { copyFrom(other); }
+			catch (...) { release(); throw; }
+		}
+		//this map is left as it was if copying throws
+		unordered_map & operator=(const unordered_map &other) {
+			if (this == &other) return *this;
+			unordered_map tmp(other);
+			std::swap(slots, tmp.slots);
+			std::swap(dist, tmp.dist);
+			std::swap(cap, tmp.cap);
+			std::swap(shift, tmp.shift);
+			std::swap(hash, tmp.hash);
+			std::swap(equal, tmp.equal);
+			std::swap(siz, tmp.siz);
+			return *this;
+		}
+		~unordered_map() { release(); }
+		T & at(const Key &key) {
+			size_t i = findSlot(key);
+			if (i != cap) return data(i).second;
+			else throw index_out_of_bound();
+		}
+		const T & at(const Key &key) const {
+			size_t i = findSlot(key);
+			if (i != cap) return data(i).second;
+			else throw index_out_of_bound();
+		}
+		T & operator[](const Key &key) {
+			size_t i = findSlot(key);
+			if (i != cap) return data(i).second;
+			pair<iterator, bool> ans = this->insert(value_type(key, T()));
+			return data(ans.first.it).second;
+		}
+		const T & operator[](const Key &key) const {
+			size_t i = findSlot(key);
+			if (i != cap) return data(i).second;
+			else throw index_out_of_bound();
+		}
+		iterator begin() { return iterator(*this, nextSlot(0)); }
+		const_iterator cbegin() const { return const_iterator(*this, nextSlot(0)); }
+		iterator end() { return iterator(*this, cap); }
+		const_iterator cend() const { return const_iterator(*this, cap); }
+		bool empty() const { return siz == 0; }
+		size_t size() const { return siz; }
+		size_t bucket_count() const { return cap; }
+		void clear() {
+			for (size_t i = 0; i < cap; i++)
+				if (dist[i] != 0) { data(i).~value_type(); dist[i] = 0; }
+			siz = 0;
+		}
+		pair<iterator, bool> insert(const value_type &x) {
+			if ((siz + 1) * 8 > cap * 7) rehash(cap == 0 ? minCap : cap * 2);
+			while (true) {
+				size_t mask = cap - 1, i = home(x.first), d = 1, p;
+				while ((p = probeLen(i)) >= d) {
+					if (p == d && equal(data(i).first, x.first)) return pair<iterator, bool>(iterator(*this, i), false);
+					i = (i + 1) & mask;
+					d++;
+				}
+				//x belongs in slot i, everything up to the next empty slot moves one step further
+				size_t j = i;
+				bool overflow = (d >= maxDist);
+				while (dist[j] != 0) {
+					if (dist[j] >= maxDist - 1) overflow = true;
+					j = (j + 1) & mask;
+				}
+				//a long probe asks for a larger table, unless the table is sparse and the hash is to blame
+				if (overflow && siz * 4 >= cap) {
+					rehash(cap * 2);
+					continue;
+				}
+				for (; j != i; j = (j - 1) & mask) moveSlot(j, (j - 1) & mask, probeLen((j - 1) & mask) + 1);
+				try { new (slots + i) value_type(x); }
+				catch (...) { closeGap(i); throw; }
+				setDist(i, d);
+				siz++;
+				return pair<iterator, bool>(iterator(*this, i), true);
+			}
+		}
+		void erase(iterator pos) {
+			if (this->empty()) throw invalid_iterator();
+			if (pos.mPtr != this) throw invalid_iterator();
+			if (pos == this->end()) throw index_out_of_bound();
+			eraseSlot(pos.it);
+		}
+		void erase(iterator first, iterator last) {
+			if (first.mPtr != this || last.mPtr != this || last.it < first.it) throw invalid_iterator();
+			//each erase pulls the rest of its cluster back one slot, so slot i is looked at again;
+			//when the pull reaches the slot at end, the element there came from outside the range
+			size_t mask = cap - 1, i = first.it, end = last.it;
+			while (i < end) {
+				if (dist[i] == 0) { i++; continue; }
+				size_t emptied = eraseSlot(i);
+				if (((emptied - i) & mask) >= end - i) end--;
+			}
+		}
+		size_t erase(const Key &key) {
+			size_t i = findSlot(key);
+			if (i == cap) return 0;
+			eraseSlot(i);
+			return 1;
+		}
+		size_t count(const Key &key) const {
+			if (findSlot(key) == cap) return 0;
+			else return 1;
+		}
+		iterator find(const Key &key) { return iterator(*this, findSlot(key)); }
+		const_iterator find(const Key &key) const { return const_iterator(*this, findSlot(key)); }
+
+	private:
+		value_type & data(size_t i) const { return *reinterpret_cast<value_type *>(slots + i); }
+		//Fibonacci hashing spreads weak hashes such as the identity on integers
+		size_t home(const Key &key) const {
+			return (size_t)(((unsigned long long)hash(key) * 0x9E3779B97F4A7C15ull) >> shift);
+		}
+		//distance of slot i from its element's home plus one, 0 if it is empty
+		size_t probeLen(size_t i) const {
+			if (dist[i] < maxDist) return dist[i];
+			return ((i - home(data(i).first)) & (cap - 1)) + 1;
+		}
+		void setDist(size_t i, size_t d) { dist[i] = (unsigned char)(d < maxDist ? d : maxDist); }
+		size_t findSlot(const Key &key) const {
+			if (siz == 0) return cap;
+			size_t mask = cap - 1, i = home(key), d = 1, p;
+			while ((p = probeLen(i)) >= d) {
+				if (p == d && equal(data(i).first, key)) return i;
+				i = (i + 1) & mask;
+				d++;
+			}
+			return cap;
+		}
+		size_t nextSlot(size_t i) const {
+			while (i < cap && dist[i] == 0) i++;
+			return i;
+		}
+		size_t prevSlot(size_t i) const {//cap if there is none
+			while (i > 0) {
+				i--;
+				if (dist[i] != 0) return i;
+			}
+			return cap;
+		}
+		void moveSlot(size_t to, size_t from, size_t d) {
+			new (slots + to) value_type(static_cast<value_type &&>(data(from)));
+			data(from).~value_type();
+			setDist(to, d);
+			dist[from] = 0;
+		}
+		//slot i has just been emptied: pull the rest of its cluster one step back,
+		//returns the slot left empty at the end
+		size_t closeGap(size_t i) {
+			size_t mask = cap - 1, j = (i + 1) & mask;
+			dist[i] = 0;
+			while (dist[j] > 1) {
+				moveSlot(i, j, probeLen(j) - 1);
+				i = j;
+				j = (j + 1) & mask;
+			}
+			return i;
+		}
+		size_t eraseSlot(size_t i) {
+			data(i).~value_type();
+			siz--;
+			return closeGap(i);
+		}
+		void allocate(size_t n) {
+			slots = static_cast<slot *>(::operator new(n * sizeof(slot)));
+			dist = new unsigned char[n];
+			memset(dist, 0, n);
+			cap = n;
+			shift = 64;
+			while (n > 1) { n >>= 1; shift--; }
+		}
+		void release() {
+			if (cap == 0) return;
+			clear();
+			::operator delete(slots);
+			delete[] dist;
+			slots = NULL;
+			dist = NULL;
+			cap = 0;
+			shift = 64;
+		}
+		void rehash(size_t n) {
+			slot *oldSlots = slots;
+			unsigned char *oldDist = dist;
+			size_t oldCap = cap;
+			allocate(n);
+			size_t mask = cap - 1;
+			for (size_t k = 0; k < oldCap; k++) {
+				if (oldDist[k] == 0) continue;
+				value_type &x = *reinterpret_cast<value_type *>(oldSlots + k);
+				size_t i = home(x.first), d = 1;
+				while (probeLen(i) >= d) {
+					i = (i + 1) & mask;
+					d++;
+				}
+				size_t j = i;
+				while (dist[j] != 0) j = (j + 1) & mask;
+				for (; j != i; j = (j - 1) & mask) moveSlot(j, (j - 1) & mask, probeLen((j - 1) & mask) + 1);
+				new (slots + i) value_type(static_cast<value_type &&>(x));
+				x.~value_type();
+				setDist(i, d);
+			}
+			if (oldCap != 0) {
+				::operator delete(oldSlots);
+				delete[] oldDist;
+			}
+		}
+		void copyFrom(const unordered_map &other) {
+			if (other.cap == 0) return;
+			allocate(other.cap);
+			for (size_t i = 0; i < cap; i++) {
+				if (other.dist[i] == 0) continue;
+				new (slots + i) value_type(other.data(i));
+				dist[i] = other.dist[i];
+				siz++;
+			}
+		}
+	};
+
+}
+#endif
@@ -1,6 +1,8 @@
 #ifndef SJTU_UTILITY_HPP
 #define SJTU_UTILITY_HPP
 
+#include <cstddef>
+#include <tuple>
 #include <utility>
 
 namespace sjtu {
@@ -15,11 +17,19 @@ namespace sjtu {
         pair(pair &&other) = default;
         pair(const T1 &x, const T2 &y) : first(x), second(y) {}
         template<class U1, class U2>
-        pair(U1 &&x, U2 &&y) : first(x), second(y) {}
+        pair(U1 &&x, U2 &&y) : first(std::forward<U1>(x)), second(std::forward<U2>(y)) {}
         template<class U1, class U2>
         pair(const pair<U1, U2> &other) : first(other.first), second(other.second) {}
         template<class U1, class U2>
-        pair(pair<U1, U2> &&other) : first(other.first), second(other.second) {}
+        pair(pair<U1, U2> &&other) : first(std::forward<U1>(other.first)), second(std::forward<U2>(other.second)) {}
+        // builds first and second in place from the two argument tuples
+        template<class... Args1, class... Args2>
+        pair(std::piecewise_construct_t, std::tuple<Args1...> x, std::tuple<Args2...> y)
+            : pair(x, y, std::index_sequence_for<Args1...>(), std::index_sequence_for<Args2...>()) {}
+    private:
+        template<class Tuple1, class Tuple2, size_t... I1, size_t... I2>
+        pair(Tuple1 &x, Tuple2 &y, std::index_sequence<I1...>, std::index_sequence<I2...>)
+            : first(std::get<I1>(std::move(x))...), second(std::get<I2>(std::move(y))...) {}
     };
     
 }